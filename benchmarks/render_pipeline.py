@@ -0,0 +1,332 @@
+"""
+Headless benchmarks of the render pipeline.
+
+Each benchmark builds a representative gadget tree on a root without a terminal,
+changes part of the tree every frame, and times each phase of producing a frame:
+region computation, painting gadgets, handing the frame to the output, and (on the
+output's writer thread) diffing/encoding the canvas as ANSI and writing it. Frames are
+written by a real :class:`Vt100_Output` to the null device, so frames replaced before
+they were written are counted as skipped. The size of each written frame is also
+reported.
+
+Run with ``python benchmarks/render_pipeline.py``. Use ``--help`` for options.
+"""
+import argparse
+import asyncio
+import os
+from collections.abc import Callable
+from pathlib import Path
+from statistics import mean, median
+from string import ascii_letters
+from tempfile import TemporaryDirectory
+from time import perf_counter
+
+import cv2
+import numpy as np
+from batgrl.colors import BLACK, DEFAULT_COLOR_THEME
+from batgrl.gadgets._root import _Root
+from batgrl.gadgets.behaviors.themable import Themable
+from batgrl.gadgets.data_table import DataTable, VirtualDataTable
+from batgrl.gadgets.graphics import Graphics
+from batgrl.gadgets.scroll_view import ScrollView
+from batgrl.gadgets.text import Text
+from batgrl.gadgets.video import Video
+from batgrl.gadgets.window import Window
+from batgrl.geometry import Size
+from batgrl.io.output.vt100 import Vt100_Output
+
+RNG = np.random.default_rng(0)
+LETTERS = np.array([*ascii_letters, " "])
+
+VIDEO_FPS = 240
+"""Frame rate of the generated video, high enough to update nearly every frame."""
+_VIDEO_DIR = TemporaryDirectory()
+"""Directory of the generated video."""
+
+Benchmark = Callable[[_Root], Callable[[int], None]]
+"""Builds a gadget tree on a root and returns a function that updates it each frame."""
+
+
+class NullOutput(Vt100_Output):
+    """A vt100 output that writes to the null device and records each written frame."""
+
+    def __init__(self):
+        super().__init__()
+        self._null = os.open(os.devnull, os.O_WRONLY)
+        self.writes: list[tuple[float, float, int]] = []
+        """Encode time, write time and bytes of each written frame."""
+
+    def _write(self, data: str) -> int:
+        encoded = data.encode(errors="replace")
+        os.write(self._null, encoded)
+        return len(encoded)
+
+    def _write_frame(self, *frame):
+        super()._write_frame(*frame)
+        self.writes.append((self.encode_time, self.write_time, self.frame_bytes))
+
+    def close(self):
+        """Close the null device."""
+        os.close(self._null)
+
+
+def random_text(text: Text):
+    """Fill a text gadget with random letters."""
+    text.canvas["char"] = RNG.choice(LETTERS, text.size)
+    text.canvas["fg_color"] = RNG.integers(0, 256, (*text.size, 3), np.uint8)
+    text.mark_dirty()
+
+
+def text_panes(root: _Root) -> Callable[[int], None]:
+    """Many small translucent text panes, a few of which move each frame."""
+    h, w = root.size
+    panes = []
+    for _ in range(100):
+        pane = Text(
+            size=(8, 20),
+            pos=(RNG.integers(0, h - 8), RNG.integers(0, w - 20)),
+            is_transparent=True,
+            alpha=0.5,
+        )
+        random_text(pane)
+        panes.append(pane)
+    root.add_gadgets(*panes)
+
+    def update(frame: int):
+        for pane in panes[frame % 10 :: 10]:
+            pane.top = (pane.top + 1) % (h - 8)
+            random_text(pane)
+
+    return update
+
+
+def windows(root: _Root) -> Callable[[int], None]:
+    """Overlapping translucent windows; the front window moves each frame."""
+    h, w = root.size
+    wins = []
+    for i in range(8):
+        window = Window(
+            title=f"Window {i}", size=(h // 2, w // 3), pos=(2 * i, 6 * i), alpha=0.7
+        )
+        window.view = view = Text(size=(h // 2, w // 3))
+        random_text(view)
+        wins.append(window)
+    root.add_gadgets(*wins)
+
+    def update(frame: int):
+        front = wins[frame % len(wins)]
+        front.pull_to_front()
+        front.left = (front.left + 1) % (w - front.width)
+
+    return update
+
+
+def data_table(root: _Root) -> Callable[[int], None]:
+    """A large data table scrolled each frame."""
+    nrows = 2000
+    data = {
+        f"Column {i}": RNG.integers(0, 1_000_000, nrows).tolist() for i in range(8)
+    }
+    table = DataTable(data=data, size_hint={"height_hint": 1.0, "width_hint": 1.0})
+    root.add_gadget(table)
+    scroll_view = table._scroll_view
+
+    def update(frame: int):
+        scroll_view.vertical_proportion = frame % 100 / 100
+
+    return update
+
+
+def virtual_data_table(root: _Root) -> Callable[[int], None]:
+    """A virtual data table of many more rows scrolled each frame."""
+    nrows = 100_000
+    data = {
+        f"Column {i}": RNG.integers(0, 1_000_000, nrows).tolist() for i in range(8)
+    }
+    table = VirtualDataTable(
+        data=data, size_hint={"height_hint": 1.0, "width_hint": 1.0}
+    )
+    root.add_gadget(table)
+    scroll_view = table._scroll_view
+
+    def update(frame: int):
+        scroll_view.vertical_proportion = frame % 100 / 100
+
+    return update
+
+
+def graphics(root: _Root) -> Callable[[int], None]:
+    """A full-screen graphic whose texture is replaced every frame, like a video."""
+    h, w = root.size
+    graphic = Graphics(is_transparent=False, size=(h, w))
+    root.add_gadget(graphic)
+    frames = RNG.integers(0, 256, (4, 2 * h, w, 4), np.uint8)
+
+    def update(frame: int):
+        graphic.texture = frames[frame % len(frames)]
+
+    return update
+
+
+def video(root: _Root) -> Callable[[int], None]:
+    """A full-screen video decoded from a generated file."""
+    h, w = root.size
+    path = Path(_VIDEO_DIR.name) / "noise.avi"
+    if not path.exists():
+        writer = cv2.VideoWriter(
+            str(path), cv2.VideoWriter_fourcc(*"MJPG"), VIDEO_FPS, (2 * w, 4 * h)
+        )
+        for _ in range(VIDEO_FPS):
+            writer.write(RNG.integers(0, 256, (4 * h, 2 * w, 3), np.uint8))
+        writer.release()
+
+    player = Video(source=path, size=(h, w))
+    root.add_gadget(player)
+    player.play()
+    return lambda frame: None  # New frames come from the decoder.
+
+
+def scroll_view(root: _Root) -> Callable[[int], None]:
+    """A scroll view of large text content scrolled each frame."""
+    view = Text(size=(1000, 500))
+    random_text(view)
+    scroll_view = ScrollView(size_hint={"height_hint": 1.0, "width_hint": 1.0})
+    scroll_view.view = view
+    root.add_gadget(scroll_view)
+
+    def update(frame: int):
+        scroll_view.vertical_proportion = frame % 100 / 100
+        scroll_view.horizontal_proportion = frame % 50 / 50
+
+    return update
+
+
+BENCHMARKS: dict[str, Benchmark] = {
+    "text_panes": text_panes,
+    "windows": windows,
+    "data_table": data_table,
+    "virtual_data_table": virtual_data_table,
+    "graphics": graphics,
+    "video": video,
+    "scroll_view": scroll_view,
+}
+
+
+async def run_benchmark(
+    benchmark: Benchmark,
+    size: Size,
+    nframes: int,
+    render_mode: str,
+    damage_tracking: bool,
+) -> tuple[dict[str, list[float]], int]:
+    """
+    Render `nframes` frames of a benchmark and return timings of each phase and the
+    number of skipped frames.
+    """
+    root = _Root(
+        app=None,
+        render_mode=render_mode,
+        bg_color=BLACK,
+        size=size,
+        damage_tracking=damage_tracking,
+    )
+    update = benchmark(root)
+    output = NullOutput()
+    phases = {"regions": [], "paint": [], "submit": []}
+
+    with output:
+        for frame in range(nframes):
+            update(frame)
+            await asyncio.sleep(0)  # Let background tasks, e.g. video, run.
+            root._render()
+
+            start = perf_counter()
+            output.render_frame(root)
+            submit_time = perf_counter() - start
+
+            if frame == 0:
+                continue  # First frame is a full repaint; don't count it.
+
+            phases["regions"].append(root._regions_time)
+            phases["paint"].append(root._paint_time)
+            phases["submit"].append(submit_time)
+
+    root.prolicide()
+    output.close()
+
+    writes = output.writes[1:]
+    phases["encode"] = [encode for encode, _, _ in writes]
+    phases["write"] = [write for _, write, _ in writes]
+    phases["bytes"] = [nbytes for _, _, nbytes in writes]
+    return phases, output.skipped_frames
+
+
+def _mean(values: list[float]) -> float:
+    """Mean of values or 0 if there are none, e.g., if no frame changed."""
+    return mean(values) if values else 0.0
+
+
+def main():
+    """Run benchmarks and print a table of results."""
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument(
+        "benchmarks",
+        nargs="*",
+        metavar="benchmark",
+        help=f"Benchmarks to run from {', '.join(BENCHMARKS)}. Defaults to all.",
+    )
+    parser.add_argument("--frames", type=int, default=200, help="Frames to render.")
+    parser.add_argument("--height", type=int, default=50, help="Screen height.")
+    parser.add_argument("--width", type=int, default=200, help="Screen width.")
+    parser.add_argument(
+        "--render-mode", choices=["regions", "painter"], default="regions"
+    )
+    parser.add_argument(
+        "--damage-tracking", action="store_true", help="Enable damage tracking."
+    )
+    args = parser.parse_args()
+    if unknown := set(args.benchmarks) - BENCHMARKS.keys():
+        parser.error(f"unknown benchmarks: {', '.join(sorted(unknown))}")
+
+    Themable.set_theme(DEFAULT_COLOR_THEME)
+    size = Size(args.height, args.width)
+
+    header = (
+        f"{'benchmark':<18} {'regions ms':>11} {'paint ms':>9} {'submit ms':>10} "
+        f"{'encode ms':>10} {'write ms':>9} {'total ms':>9} {'p50 total':>10} "
+        f"{'KiB/frame':>10} {'skipped':>8}"
+    )
+    print(header)
+    print("-" * len(header))
+    for name in args.benchmarks or BENCHMARKS:
+        phases, skipped = asyncio.run(
+            run_benchmark(
+                BENCHMARKS[name],
+                size,
+                args.frames,
+                args.render_mode,
+                args.damage_tracking,
+            )
+        )
+        # Time spent on the event loop per frame; encoding and writing run on the
+        # output's writer thread.
+        totals = [
+            sum(times)
+            for times in zip(phases["regions"], phases["paint"], phases["submit"])
+        ]
+        print(
+            f"{name:<18} "
+            f"{1000 * mean(phases['regions']):>11.3f} "
+            f"{1000 * mean(phases['paint']):>9.3f} "
+            f"{1000 * mean(phases['submit']):>10.3f} "
+            f"{1000 * _mean(phases['encode']):>10.3f} "
+            f"{1000 * _mean(phases['write']):>9.3f} "
+            f"{1000 * mean(totals):>9.3f} "
+            f"{1000 * median(totals):>10.3f} "
+            f"{_mean(phases['bytes']) / 1024:>10.1f} "
+            f"{skipped:>8}"
+        )
+
+
+if __name__ == "__main__":
+    main()
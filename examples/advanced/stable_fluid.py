@@ -5,6 +5,7 @@ Click to add fluid.
 "r" to reset.
 """
 import asyncio
+from collections import deque
 from itertools import cycle
 
 import numpy as np
@@ -42,6 +43,8 @@ EPSILON = np.finfo(float).eps
 class StableFluid(Graphics):
     def __init__(self, default_color=ABLACK, **kwargs):
         super().__init__(default_color=default_color, **kwargs)
+        # Clicks are queued and applied by the solver thread, which owns the arrays.
+        self._pokes = deque()
 
     def on_add(self):
         super().on_add()
@@ -69,23 +72,8 @@ class StableFluid(Graphics):
             return False
 
         y, x = self.to_local(mouse_event.position)
-        y *= 2
-
-        ys, xs = self.indices
-        ry = ys - y
-        rx = xs - x
-        d = ry**2 + rx**2 + EPSILON
-
-        if mouse_event.button is MouseButton.LEFT:
-            self.velocity[0] += ry / d
-            self.velocity[1] += rx / d
-        else:
-            self.velocity[0] -= ry / d
-            self.velocity[1] -= rx / d
-
-        poke_force = np.e ** (-d / POKE_RADIUS)
-        self.dye += np.moveaxis(poke_force[..., None] * next(RAINBOW_COLORS), -1, 0)
-
+        is_left = mouse_event.button is MouseButton.LEFT
+        self._pokes.append((2 * y, x, is_left, next(RAINBOW_COLORS)))
         return True
 
     def on_key(self, key_event):
@@ -96,65 +84,86 @@ class StableFluid(Graphics):
 
     async def _update(self):
         while True:
-            vy, vx = velocity = self.velocity
+            # Numerics run on another thread so the app stays responsive.
+            self.commit(await asyncio.to_thread(self._step))
+
+    def _step(self):
+        # Arrays are replaced on reset, so the same arrays are used for the whole step.
+        vy, vx = velocity = self.velocity
+        r, g, b, a = dye = self.dye
+        indices = self.indices
+
+        while self._pokes:
+            y, x, is_left, color = self._pokes.popleft()
+            ys, xs = indices
+            ry = ys - y
+            rx = xs - x
+            d = ry**2 + rx**2 + EPSILON
+
+            if is_left:
+                vy += ry / d
+                vx += rx / d
+            else:
+                vy -= ry / d
+                vx -= rx / d
 
-            # Vorticity
-            ###########
-            div_y = convolve(vy, DIF_KERNEL[None])
-            div_x = convolve(vx, DIF_KERNEL[:, None])
+            poke_force = np.e ** (-d / POKE_RADIUS)
+            dye += np.moveaxis(poke_force[..., None] * color, -1, 0)
 
-            curl = div_y - div_x
+        # Vorticity
+        ###########
+        div_y = convolve(vy, DIF_KERNEL[None])
+        div_x = convolve(vx, DIF_KERNEL[:, None])
 
-            vort_y = convolve(curl, DIF_KERNEL[None])
-            vort_x = convolve(curl, DIF_KERNEL[:, None])
+        curl = div_y - div_x
 
-            vorticity = np.stack((vort_x, vort_y))
+        vort_y = convolve(curl, DIF_KERNEL[None])
+        vort_x = convolve(curl, DIF_KERNEL[:, None])
 
-            # Negating `vort_y`` and using `vorticity=np.stack((vort_y, vort_x))`
-            # creates a more swirly effect, but there are line artifacts.
+        vorticity = np.stack((vort_x, vort_y))
 
-            vorticity /= np.linalg.norm(vorticity, axis=0) + EPSILON
-            vorticity *= curl * CURL
+        # Negating `vort_y`` and using `vorticity=np.stack((vort_y, vort_x))`
+        # creates a more swirly effect, but there are line artifacts.
 
-            velocity += vorticity
+        vorticity /= np.linalg.norm(vorticity, axis=0) + EPSILON
+        vorticity *= curl * CURL
 
-            # Pressure Solver
-            #################
-            div = 0.25 * (div_y + div_x)
+        velocity += vorticity
 
-            pressure = np.full_like(div_y, PRESSURE)
-            for _ in range(PRESSURE_ITERATIONS):
-                convolve(pressure, PRESSURE_KERNEL, output=pressure)
-                pressure -= div
+        # Pressure Solver
+        #################
+        div = 0.25 * (div_y + div_x)
 
-            # Project
-            #########
-            vy -= convolve(pressure, GRAD_KERNEL[None])
-            vx -= convolve(pressure, GRAD_KERNEL[:, None])
+        pressure = np.full_like(div_y, PRESSURE)
+        for _ in range(PRESSURE_ITERATIONS):
+            convolve(pressure, PRESSURE_KERNEL, output=pressure)
+            pressure -= div
 
-            # Advect
-            ########
-            coords = self.indices - velocity
+        # Project
+        #########
+        vy -= convolve(pressure, GRAD_KERNEL[None])
+        vx -= convolve(pressure, GRAD_KERNEL[:, None])
 
-            map_coordinates(vy, coords, output=vy, prefilter=False)
-            map_coordinates(vx, coords, output=vx, prefilter=False)
+        # Advect
+        ########
+        coords = indices - velocity
 
-            # Remove checkboard divergence and diffuse velocity.
-            convolve(vy, GAUSSIAN_KERNEL, output=vy)
-            convolve(vx, GAUSSIAN_KERNEL, output=vx)
+        map_coordinates(vy, coords, output=vy, prefilter=False)
+        map_coordinates(vx, coords, output=vx, prefilter=False)
 
-            r, g, b, a = dye = self.dye
-            map_coordinates(r, coords, output=r)
-            map_coordinates(g, coords, output=g)
-            map_coordinates(b, coords, output=b)
-            map_coordinates(a, coords, output=a)
+        # Remove checkboard divergence and diffuse velocity.
+        convolve(vy, GAUSSIAN_KERNEL, output=vy)
+        convolve(vx, GAUSSIAN_KERNEL, output=vx)
 
-            dye *= DISSIPATION
-            np.clip(dye, 0, 255, out=dye)
+        map_coordinates(r, coords, output=r)
+        map_coordinates(g, coords, output=g)
+        map_coordinates(b, coords, output=b)
+        map_coordinates(a, coords, output=a)
 
-            self.texture[:] = np.moveaxis(dye, 0, -1)
+        dye *= DISSIPATION
+        np.clip(dye, 0, 255, out=dye)
 
-            await asyncio.sleep(0)
+        return np.moveaxis(dye, 0, -1).astype(np.uint8)
 
 
 class StableFluidApp(App):
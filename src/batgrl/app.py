@@ -3,12 +3,14 @@ import asyncio
 import platform
 import sys
 from abc import ABC, abstractmethod
+from collections.abc import Callable, Iterable, Iterator
 from contextlib import redirect_stderr
-from io import StringIO
+from dataclasses import dataclass
+from io import BytesIO, StringIO
 from pathlib import Path
 from time import monotonic
 from types import ModuleType
-from typing import Literal
+from typing import BinaryIO, Literal
 
 from .colors import BLACK, DEFAULT_COLOR_THEME, Color, ColorTheme
 from .gadgets._root import _Root
@@ -24,9 +26,55 @@ from .io import (
     PasteEvent,
     _PartialMouseEvent,
 )
+from .io.input.headless import HeadlessInput
+from .io.output._graphics_protocols import GraphicsProtocol
+from .io.output.headless import HeadlessOutput
 from .io.output.vt100 import Vt100_Output
 
-__all__ = ["App", "run_gadget_as_app"]
+__all__ = ["App", "FrameProfile", "run_gadget_as_app"]
+
+
+@dataclass(frozen=True, slots=True)
+class FrameProfile:
+    """
+    Timings of each phase of rendering a frame.
+
+    Frames are encoded and written on an output thread, so `encode`, `write`, and
+    `nbytes` are of the last frame written to the terminal, which may lag behind the
+    frame just rendered.
+
+    Parameters
+    ----------
+    regions : float
+        Seconds spent recomputing gadget regions.
+    paint : float
+        Seconds spent painting gadgets.
+    encode : float
+        Seconds spent diffing and encoding the last written frame.
+    write : float
+        Seconds spent writing the last written frame.
+    nbytes : int
+        Number of bytes in the last written frame.
+
+    Attributes
+    ----------
+    regions : float
+        Seconds spent recomputing gadget regions.
+    paint : float
+        Seconds spent painting gadgets.
+    encode : float
+        Seconds spent diffing and encoding the last written frame.
+    write : float
+        Seconds spent writing the last written frame.
+    nbytes : int
+        Number of bytes in the last written frame.
+    """
+
+    regions: float
+    paint: float
+    encode: float
+    write: float
+    nbytes: int
 
 
 class App(ABC):
@@ -43,20 +91,74 @@ class App(ABC):
         Max duration of a double-click. Max duration of a triple-click
         is double this value.
     render_interval : float, default: 0.0
-        Seconds between screen renders.
+        Seconds between screen renders. If rendering on demand, the minimum seconds
+        between screen renders.
+    render_on_demand : bool, default: False
+        Whether the screen is only rendered when a frame is requested. Frames are
+        requested on input, when bindable gadget properties change, when gadget
+        geometry changes, when gadgets are marked dirty, or with :meth:`request_frame`.
+        Requests are coalesced so that at most one frame is rendered every
+        :attr:`render_interval` seconds and the app sleeps while no frames are
+        requested.
     color_theme : ColorTheme, default: DEFAULT_COLOR_THEME
         Color theme used for :class:`batgrl.gadgets.behaviors.themable.Themable`
         gadgets.
     asciicast_path : Path | None, default: None
         Record the terminal in asciicast v2 file format if a path is provided.
         Resizing the terminal while recording isn't currently supported by
-        the asciicast format -- doing so will corrupt the recording.
+        the asciicast format -- doing so will corrupt the recording. If the path ends
+        with ``.gz``, the recording is gzip-compressed in chunks and an index of the
+        chunks is written alongside it.
     redirect_stderr : Path | None, default: None
         If provided, stderr is written to this path.
     render_mode : Literal["regions", "painter"], default: "regions"
         Determines how the gadget tree is rendered. "painter" fully paints every gadget
         back-to-front. "regions" only paints the visible portion of each gadget.
         "painter" may be more efficient for a large number of non-overlapping gadgets.
+    damage_tracking : bool, default: False
+        Whether only damaged portions of the screen are repainted each frame. A portion
+        of the screen is damaged if the geometry of a gadget there changes or if the
+        gadget is marked dirty with :meth:`batgrl.gadgets.gadget.Gadget.mark_dirty`.
+        Gadgets that modify their content directly must be marked dirty to be
+        repainted.
+    hit_test_mouse_moves : bool, default: False
+        Whether mouse moves are only dispatched to gadgets under the current or last
+        mouse position, grabbed gadgets, and their ancestors, instead of to every
+        gadget. Other mouse events are always dispatched to every gadget.
+    batch_layout : bool, default: False
+        Whether size and pos hints of children of resized gadgets are applied once,
+        parents first, before the next frame is rendered instead of immediately on
+        every resize. Each subtree is then laid out at most once per frame, but hinted
+        gadgets' geometry isn't updated until the next frame.
+    graphics_protocol : GraphicsProtocol, default: "half-blocks"
+        How graphic gadgets are output. "half-blocks" paints their textures with the
+        upper half block character. "kitty" and "sixel" send the visible regions of
+        graphic gadgets in the gadget tree to the terminal as images with the kitty
+        graphics protocol or as sixels. The terminal must support the protocol. With
+        "kitty", textures are only sent when they change, through temporary files if
+        the terminal is local.
+    synchronized_output : bool, default: True
+        Whether frames are wrapped in synchronized output (DEC mode 2026) so that
+        terminals don't display half-written frames. Terminals that don't support it
+        ignore it.
+    adaptive_bandwidth : bool, default: False
+        Whether output adapts to the measured throughput of the terminal. Frames are
+        paced to stay within a budget of bytes per second (newer frames replace frames
+        waiting to be written, lowering the frame rate) and colors are quantized to the
+        256-color palette while the byte rate is at the budget.
+    bandwidth_limit : float | None, default: None
+        Budget in bytes per second if :attr:`adaptive_bandwidth` is true. If not
+        provided, the budget is measured from writes that block.
+    frame_profiler : Callable[[FrameProfile], None] | None, default: None
+        If provided, called with a :class:`FrameProfile` after every frame is rendered.
+    headless : bool, default: False
+        Whether to run without a terminal. Frames are rendered at `headless_size` into
+        `headless_stream` and input events are only created with :meth:`send_events`.
+    headless_size : Size, default: Size(24, 80)
+        Size of screen if headless.
+    headless_stream : BinaryIO | int | None, default: None
+        Binary stream or file descriptor frames are written to if headless. If not
+        provided, frames are written to a new :class:`io.BytesIO`.
 
     Attributes
     ----------
@@ -69,6 +171,12 @@ class App(ABC):
         is double this value.
     render_interval : float
         Seconds between screen renders.
+    render_on_demand : bool
+        Whether the screen is only rendered when a frame is requested.
+    frame_time : float
+        Seconds taken to render the last frame.
+    dropped_frames : int
+        Number of frames that took longer than :attr:`render_interval` to render.
     color_theme : ColorTheme
         Color theme used for :class:`batgrl.gadgets.behaviors.themable.Themable`
         gadgets.
@@ -76,6 +184,28 @@ class App(ABC):
         Path where asciicast recording will be saved.
     redirect_stderr : Path | None
         Path where stderr is saved.
+    damage_tracking : bool
+        Whether only damaged portions of the screen are repainted each frame.
+    hit_test_mouse_moves : bool
+        Whether mouse moves are only dispatched to gadgets under the mouse.
+    batch_layout : bool
+        Whether hints are applied once per frame instead of on every resize.
+    graphics_protocol : GraphicsProtocol
+        How graphic gadgets are output.
+    synchronized_output : bool
+        Whether frames are wrapped in synchronized output.
+    adaptive_bandwidth : bool
+        Whether output adapts to the measured throughput of the terminal.
+    bandwidth_limit : float | None
+        Budget in bytes per second if :attr:`adaptive_bandwidth` is true.
+    frame_profiler : Callable[[FrameProfile], None] | None
+        Called with a :class:`FrameProfile` after every frame is rendered.
+    headless : bool
+        Whether app runs without a terminal.
+    headless_size : Size
+        Size of screen if headless.
+    headless_stream : BinaryIO | int | None
+        Binary stream or file descriptor frames are written to if headless.
     root : _Root | None
         Root of gadget tree.
     children : list[Gadget]
@@ -89,6 +219,10 @@ class App(ABC):
         Run the app.
     exit()
         Exit the app.
+    request_frame()
+        Request that the screen be rendered.
+    send_events(\*events)
+        Send input events to a headless app.
     add_gadget(gadget)
         Alias for :attr:`root.add_gadget`.
     add_gadgets(\*gadgets)
@@ -102,10 +236,22 @@ class App(ABC):
         title: str | None = None,
         double_click_timeout: float = 0.5,
         render_interval: float = 0.0,
+        render_on_demand: bool = False,
         color_theme: ColorTheme = DEFAULT_COLOR_THEME,
         asciicast_path: Path | None = None,
         redirect_stderr: Path | None = None,
         render_mode: Literal["regions", "painter"] = "regions",
+        damage_tracking: bool = False,
+        hit_test_mouse_moves: bool = False,
+        batch_layout: bool = False,
+        graphics_protocol: GraphicsProtocol = "half-blocks",
+        synchronized_output: bool = True,
+        adaptive_bandwidth: bool = False,
+        bandwidth_limit: float | None = None,
+        frame_profiler: Callable[[FrameProfile], None] | None = None,
+        headless: bool = False,
+        headless_size: Size = Size(24, 80),
+        headless_stream: BinaryIO | int | None = None,
     ):
         self.root = None
 
@@ -113,10 +259,30 @@ class App(ABC):
         self.title = title
         self.double_click_timeout = double_click_timeout
         self.render_interval = render_interval
+        self.render_on_demand = render_on_demand
+        self.frame_time = 0.0
+        self.dropped_frames = 0
+        self._loop: asyncio.AbstractEventLoop | None = None
+        self._frame_requested: asyncio.Event | None = None
         self.color_theme = color_theme
         self.asciicast_path = asciicast_path
         self.redirect_stderr = redirect_stderr
         self.render_mode = render_mode
+        self.damage_tracking = damage_tracking
+        self.hit_test_mouse_moves = hit_test_mouse_moves
+        self.batch_layout = batch_layout
+        self.graphics_protocol = graphics_protocol
+        self._output: Vt100_Output | None = None
+        self.synchronized_output = synchronized_output
+        self.adaptive_bandwidth = adaptive_bandwidth
+        self.bandwidth_limit = bandwidth_limit
+        self.frame_profiler = frame_profiler
+        self.headless = headless
+        self.headless_size = headless_size
+        if headless and headless_stream is None:
+            headless_stream = BytesIO()
+        self.headless_stream = headless_stream
+        self._input: HeadlessInput | None = None
 
     def __repr__(self):
         return (
@@ -125,9 +291,21 @@ class App(ABC):
             f"    title={self.title!r},\n"
             f"    double_click_timeout={self.double_click_timeout},\n"
             f"    render_interval={self.render_interval},\n"
+            f"    render_on_demand={self.render_on_demand},\n"
             f"    asciicast_path={self.asciicast_path},\n"
             f"    redirect_stderr={self.redirect_stderr},\n"
             f"    render_mode={self.render_mode!r},\n"
+            f"    damage_tracking={self.damage_tracking},\n"
+            f"    hit_test_mouse_moves={self.hit_test_mouse_moves},\n"
+            f"    batch_layout={self.batch_layout},\n"
+            f"    graphics_protocol={self.graphics_protocol!r},\n"
+            f"    synchronized_output={self.synchronized_output},\n"
+            f"    adaptive_bandwidth={self.adaptive_bandwidth},\n"
+            f"    bandwidth_limit={self.bandwidth_limit},\n"
+            f"    frame_profiler={self.frame_profiler!r},\n"
+            f"    headless={self.headless},\n"
+            f"    headless_size={self.headless_size},\n"
+            f"    headless_stream={self.headless_stream!r},\n"
             ")"
         )
 
@@ -168,6 +346,83 @@ class App(ABC):
         if self.root is not None:
             self.root.render_mode = render_mode
 
+    @property
+    def damage_tracking(self) -> bool:
+        """Whether only damaged portions of the screen are repainted each frame."""
+        return self._damage_tracking
+
+    @damage_tracking.setter
+    def damage_tracking(self, damage_tracking: bool):
+        self._damage_tracking = damage_tracking
+        if self.root is not None:
+            self.root.damage_tracking = damage_tracking
+
+    @property
+    def hit_test_mouse_moves(self) -> bool:
+        """Whether mouse moves are only dispatched to gadgets under the mouse."""
+        return self._hit_test_mouse_moves
+
+    @hit_test_mouse_moves.setter
+    def hit_test_mouse_moves(self, hit_test_mouse_moves: bool):
+        self._hit_test_mouse_moves = hit_test_mouse_moves
+        if self.root is not None:
+            self.root.hit_test_mouse_moves = hit_test_mouse_moves
+
+    @property
+    def batch_layout(self) -> bool:
+        """Whether hints are applied once per frame instead of on every resize."""
+        return self._batch_layout
+
+    @batch_layout.setter
+    def batch_layout(self, batch_layout: bool):
+        self._batch_layout = batch_layout
+        if self.root is not None:
+            self.root.batch_layout = batch_layout
+
+    @property
+    def graphics_protocol(self) -> GraphicsProtocol:
+        """How graphic gadgets are output."""
+        return self._graphics_protocol
+
+    @graphics_protocol.setter
+    def graphics_protocol(self, graphics_protocol: GraphicsProtocol):
+        self._graphics_protocol = graphics_protocol
+        if self.root is not None:
+            self.root.graphics_protocol = graphics_protocol
+
+    @property
+    def synchronized_output(self) -> bool:
+        """Whether frames are wrapped in synchronized output."""
+        return self._synchronized_output
+
+    @synchronized_output.setter
+    def synchronized_output(self, synchronized_output: bool):
+        self._synchronized_output = synchronized_output
+        if self._output is not None:
+            self._output.synchronized_output = synchronized_output
+
+    @property
+    def adaptive_bandwidth(self) -> bool:
+        """Whether output adapts to the measured throughput of the terminal."""
+        return self._adaptive_bandwidth
+
+    @adaptive_bandwidth.setter
+    def adaptive_bandwidth(self, adaptive_bandwidth: bool):
+        self._adaptive_bandwidth = adaptive_bandwidth
+        if self._output is not None:
+            self._output.adaptive_bandwidth = adaptive_bandwidth
+
+    @property
+    def bandwidth_limit(self) -> float | None:
+        """Budget in bytes per second if :attr:`adaptive_bandwidth` is true."""
+        return self._bandwidth_limit
+
+    @bandwidth_limit.setter
+    def bandwidth_limit(self, bandwidth_limit: float | None):
+        self._bandwidth_limit = bandwidth_limit
+        if self._output is not None:
+            self._output.bandwidth.limit = bandwidth_limit
+
     @abstractmethod
     async def on_start(self):
         """Coroutine scheduled when app is run."""
@@ -200,8 +455,66 @@ class App(ABC):
             for task in tasks:
                 task.cancel()
 
-    def _create_io(self) -> tuple[ModuleType, Vt100_Output]:
+    def request_frame(self):
+        """
+        Request that the screen be rendered.
+
+        Only needed if :attr:`render_on_demand` is true and the gadget tree is changed
+        in a way that doesn't request a frame automatically, e.g., writing into a
+        gadget's canvas directly. Can be called from any thread.
+        """
+        frame_requested = self._frame_requested
+        if frame_requested is None or frame_requested.is_set():
+            return
+
+        try:
+            running = asyncio.get_running_loop()
+        except RuntimeError:
+            running = None
+
+        if running is self._loop:
+            frame_requested.set()
+        else:
+            try:
+                self._loop.call_soon_threadsafe(frame_requested.set)
+            except RuntimeError:  # Loop is closed.
+                pass
+
+    def send_events(self, *events: KeyEvent | MouseEvent | PasteEvent | Size):
+        r"""
+        Send input events to a headless app.
+
+        Events are dispatched as if they were input from a terminal. Can be called from
+        any thread.
+
+        Parameters
+        ----------
+        \*events : KeyEvent | MouseEvent | PasteEvent | Size
+            Events to send. A size event resizes the screen.
+
+        Raises
+        ------
+        RuntimeError
+            If app isn't headless.
+        """
+        if not self.headless:
+            raise RuntimeError("Events can only be sent to a headless app.")
+
+        if self._input is None:
+            self._input = HeadlessInput()
+
+        self._input.send(*events)
+
+    def _create_io(self) -> tuple[ModuleType | HeadlessInput, Vt100_Output]:
         """Return platform specific io."""
+        if self.headless:
+            if self._input is None:
+                self._input = HeadlessInput()
+
+            return self._input, HeadlessOutput(
+                self.headless_size, self.headless_stream, self.asciicast_path
+            )
+
         if not sys.stdin.isatty():
             raise RuntimeError("Interactive terminal required.")
 
@@ -226,12 +539,24 @@ class App(ABC):
     async def _run_async(self):
         """Build environment, create root, and schedule app-specific tasks."""
         env_in, env_out = self._create_io()
+        env_out.synchronized_output = self.synchronized_output
+        env_out.adaptive_bandwidth = self.adaptive_bandwidth
+        env_out.bandwidth.limit = self.bandwidth_limit
+        self._output = env_out
+        self._loop = asyncio.get_running_loop()
+        self._frame_requested = frame_requested = asyncio.Event()
+        frame_requested.set()
+
         with env_out:
             self.root = root = _Root(
                 app=self,
                 render_mode=self.render_mode,
                 bg_color=self.bg_color,
                 size=env_out.get_size(),
+                damage_tracking=self.damage_tracking,
+                hit_test_mouse_moves=self.hit_test_mouse_moves,
+                batch_layout=self.batch_layout,
+                graphics_protocol=self.graphics_protocol,
             )
 
             if self.title:
@@ -272,7 +597,7 @@ class App(ABC):
 
             def read_from_input():
                 """Read and process input."""
-                for event in env_in.events():
+                for event in _coalesce_mouse_moves(env_in.events()):
                     match event:
                         case KeyEvent.CTRL_C:
                             self.exit()
@@ -286,17 +611,54 @@ class App(ABC):
                         case _PartialMouseEvent():
                             mouse_event = determine_nclicks(event)
                             dispatch_mouse(mouse_event)
+                        case MouseEvent():
+                            dispatch_mouse(event)
                         case PasteEvent():
                             dispatch_paste(event)
                         case Size():
                             root.size = event
 
+                self.request_frame()
+
+            def render():
+                """Render a frame and update frame statistics."""
+                start = monotonic()
+                root._render()
+                env_out.render_frame(root)
+                self.frame_time = monotonic() - start
+                if 0 < self.render_interval < self.frame_time:
+                    self.dropped_frames += 1
+
+                if self.frame_profiler is not None:
+                    self.frame_profiler(
+                        FrameProfile(
+                            root._regions_time,
+                            root._paint_time,
+                            env_out.encode_time,
+                            env_out.write_time,
+                            env_out.frame_bytes,
+                        )
+                    )
+
             async def auto_render():
                 """Render screen every :attr:`render_interval` seconds."""
+                last_frame = monotonic()
                 while True:
-                    root._render()
-                    env_out.render_frame(root)
-                    await asyncio.sleep(self.render_interval)
+                    if not self.render_on_demand:
+                        render()
+                        await asyncio.sleep(self.render_interval)
+                        continue
+
+                    await frame_requested.wait()
+
+                    # Coalesce requests until at least `render_interval` seconds have
+                    # passed since the last frame.
+                    if (elapsed := monotonic() - last_frame) < self.render_interval:
+                        await asyncio.sleep(self.render_interval - elapsed)
+
+                    last_frame = monotonic()
+                    frame_requested.clear()
+                    render()
 
             with env_in.raw_mode(), env_in.attach(read_from_input):
                 await asyncio.gather(self.on_start(), auto_render())
@@ -330,6 +692,34 @@ class App(ABC):
             return self.root.children
 
 
+def _is_mouse_move(event) -> bool:
+    """Whether an input event is a mouse move."""
+    return (
+        isinstance(event, (_PartialMouseEvent, MouseEvent))
+        and event.event_type is MouseEventType.MOUSE_MOVE
+    )
+
+
+def _coalesce_mouse_moves(events: Iterable) -> Iterator:
+    """
+    Yield input events, skipping mouse moves followed by another mouse move with the
+    same button and mods.
+    """
+    last = None
+    for event in events:
+        if last is not None and not (
+            _is_mouse_move(last)
+            and _is_mouse_move(event)
+            and last.button is event.button
+            and last.mods == event.mods
+        ):
+            yield last
+        last = event
+
+    if last is not None:
+        yield last
+
+
 def run_gadget_as_app(gadget: Gadget):
     """
     Run a gadget as a full-screen app.
@@ -3,7 +3,10 @@ from collections.abc import Callable
 from math import cos, pi, sin
 from typing import Literal
 
-__all__ = ["Easing", "EASINGS"]
+import numpy as np
+from numpy.typing import NDArray
+
+__all__ = ["Easing", "EASINGS", "ease_array"]
 
 Easing = Literal[
     "linear",
@@ -283,3 +286,38 @@ EASINGS: dict[Easing, Callable[[float], float]] = {
     "out_bounce": out_bounce,
     "in_out_bounce": in_out_bounce,
 }
+
+_EASING_TABLE_SIZE = 1025
+"""Number of samples in each easing table."""
+_EASING_TABLE_PS = np.linspace(0.0, 1.0, _EASING_TABLE_SIZE)
+"""Proportions at which easings are sampled."""
+_EASING_TABLES: dict[Easing, NDArray[np.float64]] = {}
+"""Sampled easings."""
+
+
+def ease_array(easing: Easing, p: NDArray[np.float64]) -> NDArray[np.float64]:
+    """
+    Apply an easing to an array of proportions (0 <= p <= 1).
+
+    The easing is sampled once into a table that is linearly interpolated, so whole
+    arrays are eased without calling the easing for each proportion.
+
+    Parameters
+    ----------
+    easing : Easing
+        The easing to apply.
+    p : NDArray[np.float64]
+        Proportions to ease.
+
+    Returns
+    -------
+    NDArray[np.float64]
+        The eased proportions.
+    """
+    table = _EASING_TABLES.get(easing)
+    if table is None:
+        easing_function = EASINGS[easing]
+        table = _EASING_TABLES[easing] = np.array(
+            [easing_function(p) for p in _EASING_TABLE_PS.tolist()]
+        )
+    return np.interp(p, _EASING_TABLE_PS, table)
@@ -0,0 +1,93 @@
+"""A buffer of the latest values of a data stream."""
+import numpy as np
+from numpy.typing import ArrayLike, NDArray
+
+__all__ = ["RingBuffer"]
+
+
+class RingBuffer:
+    """
+    A buffer of the latest values of a data stream.
+
+    If `capacity` is given, only the latest `capacity` values are kept. Values are
+    written twice, `capacity` apart, so the kept values are always contiguous and
+    :meth:`view` never copies. Otherwise, the buffer grows as needed.
+
+    Parameters
+    ----------
+    data : ArrayLike
+        Initial values.
+    capacity : int | None, default: None
+        Maximum number of values kept.
+
+    Attributes
+    ----------
+    capacity : int | None
+        Maximum number of values kept.
+    total : int
+        Number of values ever added to the buffer.
+
+    Methods
+    -------
+    extend(values)
+        Add values to the end of the buffer.
+    view()
+        Return a view of the kept values, oldest first.
+    """
+
+    def __init__(self, data: ArrayLike, capacity: int | None = None):
+        data = np.asarray(data, float).ravel()
+        if capacity is not None and capacity < 1:
+            raise ValueError(f"capacity must be positive, not {capacity}.")
+
+        self.capacity = capacity
+        """Maximum number of values kept."""
+        self.total = 0
+        """Number of values ever added to the buffer."""
+        size = len(data) if capacity is None else capacity
+        self._buffer: NDArray[np.float64] = np.empty(2 * max(size, 1))
+        self._start = 0
+        """Index of oldest value in buffer."""
+        self._len = 0
+        """Number of values kept."""
+        self.extend(data)
+
+    def __len__(self) -> int:
+        return self._len
+
+    def extend(self, values: ArrayLike):
+        """Add values to the end of the buffer."""
+        values = np.asarray(values, float).ravel()
+        n = len(values)
+        self.total += n
+        capacity = self.capacity
+
+        if capacity is None:
+            end = self._len + n
+            if end > len(self._buffer):
+                buffer = np.empty(max(end, 2 * len(self._buffer)))
+                buffer[: self._len] = self._buffer[: self._len]
+                self._buffer = buffer
+            self._buffer[self._len : end] = values
+            self._len = end
+            return
+
+        if n >= capacity:
+            self._buffer[:capacity] = self._buffer[capacity:] = values[-capacity:]
+            self._start = 0
+            self._len = capacity
+            return
+
+        indices = (self._start + self._len + np.arange(n)) % capacity
+        self._buffer[indices] = self._buffer[indices + capacity] = values
+        dropped = max(self._len + n - capacity, 0)
+        self._start = (self._start + dropped) % capacity
+        self._len += n - dropped
+
+    def view(self) -> NDArray[np.float64]:
+        """
+        Return a view of the kept values, oldest first.
+
+        The view is only valid until values are next added to the buffer.
+        """
+        return self._buffer[self._start : self._start + self._len]
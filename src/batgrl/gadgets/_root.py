@@ -1,14 +1,24 @@
 """Root gadget."""
-from threading import RLock
+from collections.abc import Iterator
+from heapq import heappop, heappush
+from itertools import chain, count, islice
+from threading import Event, Lock, RLock, get_ident
+from time import perf_counter
 from typing import TYPE_CHECKING, Literal
 
 import numpy as np
+from numpy.typing import NDArray
 
 if TYPE_CHECKING:
     from ..app import App
 
 from ..colors import Color
+from ..io import MouseEvent, MouseEventType
+from ..io.output._graphics_protocols import GraphicsProtocol, ImagePlacement
+from ._tween_clock import TweenClock
+from .behaviors.grabbable import Grabbable
 from .gadget import Gadget, Point, Region, Size
+from .graphics import Graphics
 from .text_tools import cell
 
 
@@ -25,13 +35,60 @@ class _Root(Gadget):
         render_mode: Literal["regions", "painter"],
         bg_color: Color,
         size: Size,
+        damage_tracking: bool = False,
+        hit_test_mouse_moves: bool = False,
+        batch_layout: bool = False,
+        graphics_protocol: GraphicsProtocol = "half-blocks",
     ):
         self._render_lock = RLock()
+        """Lock of gadget geometry, held while layout and regions are computed."""
+        self._painted = Event()
+        """Set unless a frame is being painted."""
+        self._painted.set()
+        self._painting_thread: int | None = None
+        """Ident of thread painting a frame, if any."""
+        self._commit_lock = Lock()
+        self._commits: dict[Gadget, NDArray] = {}
+        """Buffers committed from any thread, swapped in at the start of each frame."""
         self._size = -1, -1
         self.children = []
 
+        self._stale_regions: set[Gadget] = set()
+        """Gadgets whose regions need to be recomputed."""
+        self._z_order: list[Gadget] = []
+        """All gadgets in the tree from front to back."""
+        self._occlusions: list[Region] = []
+        """Visible portion of root before each gadget in `_z_order` is drawn."""
+        self._clip_region: Region = Region()
+        self._region: Region = Region()
+        self._dirty_gadgets: set[Gadget] = set()
+        """Gadgets that need to be repainted."""
+        self._damage: Region = Region()
+        """Portion of screen that needs to be repainted next frame."""
+        self._last_damage: Region = Region()
+        """Portion of screen repainted last frame."""
+        self._regions_time: float = 0.0
+        """Seconds spent recomputing regions last frame."""
+        self._paint_time: float = 0.0
+        """Seconds spent painting gadgets last frame."""
+        self._hit_rows: list[list[Gadget]] | None = None
+        """For each row of the screen, gadgets whose region intersects it."""
+        self._last_mouse_pos = Point(0, 0)
+        """Position of last dispatched mouse event."""
+        self.hit_test_mouse_moves = hit_test_mouse_moves
+        """Whether mouse moves are only dispatched to gadgets under the mouse."""
+        self._layout_pending: set[Gadget] = set()
+        """Resized gadgets whose children's hints haven't been applied."""
+        self._image_gadgets: list[Graphics] = []
+        """Graphic gadgets sent to the terminal as images from back to front."""
+        self._tween_clock = TweenClock()
+        """Advances all running tweens once per frame."""
+        self._batch_layout = batch_layout
+
         self._app = app
         self.render_mode = render_mode
+        self.damage_tracking = damage_tracking
+        self.graphics_protocol = graphics_protocol
         self._cell = cell(bg_color=bg_color)
         self.size = size
 
@@ -41,6 +98,108 @@ class _Root(Gadget):
         self.canvas = np.full((h, w), self._cell)
         self._last_canvas = self.canvas.copy()
         self._resized = True
+        self._invalidate_regions()
+        self._last_damage = Region()
+
+    @property
+    def render_mode(self) -> Literal["regions", "painter"]:
+        """Determines how the gadget tree is rendered."""
+        return self._render_mode
+
+    @render_mode.setter
+    def render_mode(self, render_mode: Literal["regions", "painter"]):
+        self._render_mode = render_mode
+        self._invalidate_regions()
+
+    @property
+    def damage_tracking(self) -> bool:
+        """Whether only damaged portions of the screen are repainted."""
+        return self._damage_tracking
+
+    @damage_tracking.setter
+    def damage_tracking(self, damage_tracking: bool):
+        self._damage_tracking = damage_tracking
+        self._invalidate_regions()
+
+    @property
+    def graphics_protocol(self) -> GraphicsProtocol:
+        """How graphic gadgets are output."""
+        return self._graphics_protocol
+
+    @graphics_protocol.setter
+    def graphics_protocol(self, graphics_protocol: GraphicsProtocol):
+        self._graphics_protocol = graphics_protocol
+        self._invalidate_regions()
+
+    def _update_image_gadgets(self):
+        """
+        Flag graphic gadgets in the gadget tree that are sent to the terminal as
+        images, so they aren't painted. Graphic gadgets outside the tree, e.g., frames
+        of an animation, are always painted. Regions must be up-to-date.
+        """
+        for gadget in self._image_gadgets:
+            gadget._as_image = False
+
+        if self._graphics_protocol == "half-blocks":
+            self._image_gadgets = []
+            return
+
+        self._image_gadgets = [
+            gadget
+            for gadget in reversed(self._z_order)
+            if isinstance(gadget, Graphics) and gadget._region
+        ]
+        for gadget in self._image_gadgets:
+            gadget._as_image = True
+
+    def _image_placements(self) -> list[ImagePlacement]:
+        """Return placements of graphic gadgets sent as images from back to front."""
+        return [gadget._image_placement() for gadget in self._image_gadgets]
+
+    @property
+    def batch_layout(self) -> bool:
+        """Whether hints are applied once per frame instead of on every resize."""
+        return self._batch_layout
+
+    @batch_layout.setter
+    def batch_layout(self, batch_layout: bool):
+        self._batch_layout = batch_layout
+        if not batch_layout:
+            self._apply_layout()
+
+    def _apply_layout(self):
+        """
+        Apply hints of children of resized gadgets, parents before children.
+
+        Applying hints may resize more gadgets. Since those are always deeper in the
+        tree, each pending gadget's children are laid out at most once per pass.
+        """
+        pending = self._layout_pending
+        if not pending:
+            return
+
+        heap = []
+        queued = set()
+        counter = count()
+
+        def push(gadget):
+            queued.add(gadget)
+            depth = sum(1 for _ in gadget.ancestors())
+            heappush(heap, (depth, next(counter), gadget))
+
+        with self._render_lock:
+            while pending or heap:
+                for gadget in pending - queued:
+                    push(gadget)
+                pending.clear()
+
+                _, _, gadget = heappop(heap)
+                queued.discard(gadget)
+                if gadget.root is not self:  # Removed since it was resized.
+                    continue
+
+                for child in gadget.children:
+                    child.apply_hints()
 
     @property
     def _pos(self) -> Point:
@@ -82,6 +241,7 @@ class _Root(Gadget):
     @bg_color.setter
     def bg_color(self, color: Color):
         self._cell["bg_color"] = color
+        self.mark_dirty()
 
     def to_local(self, point: Point) -> Point:
         return point
@@ -90,38 +250,253 @@ class _Root(Gadget):
         y, x = point
         return 0 <= y < self.height and 0 <= x < self.width
 
-    def _render(self):
-        """Render gadget tree into `canvas`."""
-        # TODO: Optimize...
-        # - Recalculating all regions every frame isn't necessary if gadget geometry
-        #   hasn't changed.
-        # - If there *is* a change to geometry, regions that are later in z-order can be
-        #   reused.
-        # - Checking for changes in geometry can be done once every few frames if
-        #   geometry has been static for some time.
+    def _update_regions(self):
+        """
+        Recompute regions of stale gadgets and every gadget behind them.
 
-        with self._render_lock:
-            self._region = Region.from_rect(self.pos, self.size)
+        Regions of gadgets in front of the earliest stale gadget (in z-order) can't have
+        changed and are reused. If tracking damage, every portion of the screen whose
+        gadget changed is added to `_damage`.
+        """
+        stale, self._stale_regions = self._stale_regions, set()
+        if not stale:
+            return
 
-            for child in self.walk():
-                child._region = (
-                    child.parent._region
+        self._hit_rows = None
+
+        z_order = [*self.walk_reverse()]
+
+        full = self in stale
+        if full:
+            start = 0
+            stale = self.children
+            self._clip_region = Region.from_rect(self.pos, self.size)
+            self._occlusions = [self._clip_region]
+            self._damage = self._clip_region
+        else:
+            # If the tree has changed, regions from the first difference are stale.
+            start = next(
+                (
+                    i
+                    for i, (old, new) in enumerate(zip(self._z_order, z_order))
+                    if old is not new
+                ),
+                min(len(self._z_order), len(z_order)),
+            )
+            z_index = {gadget: i for i, gadget in enumerate(z_order)}
+            in_tree = []
+            for gadget in stale:
+                # A gadget's descendants are directly in front of it in z-order, so the
+                # first gadget of its subtree is found by following last children.
+                first = gadget
+                while first.children:
+                    first = first.children[-1]
+
+                if (i := z_index.get(first)) is not None:
+                    in_tree.append(gadget)
+                    if i < start:
+                        start = i
+            stale = in_tree
+
+            if self.damage_tracking:
+                # Removed gadgets uncover whatever was behind them.
+                for gadget in islice(self._z_order, start, None):
+                    if gadget not in z_index:
+                        self._damage |= gadget._region
+
+        track_damage = self.damage_tracking and not full
+        reclipped = set()
+        for gadget in stale:
+            for child in chain((gadget,), gadget.walk()):
+                reclipped.add(child)
+                child._clip_region = (
+                    child.parent._clip_region
                     & Region.from_rect(child.absolute_pos, child.size)
                     if child.is_enabled and child.is_visible
                     else Region()
                 )
 
-            if self.render_mode == "regions":
-                for child in self.walk_reverse():
-                    if child.is_enabled:
-                        child._region &= self._region
-                        if child.is_visible and not child.is_transparent:
-                            self._region -= child._region
+        self._z_order = z_order
+        del self._occlusions[start + 1 :]
+        visible = self._occlusions[start]
+        for child in islice(z_order, start, None):
+            old_region = child._region
+            if self.render_mode == "regions" and child.is_enabled:
+                child._region = child._clip_region & visible
+                if child.is_visible and not child.is_transparent:
+                    visible -= child._region
+            else:
+                child._region = child._clip_region
+            self._occlusions.append(visible)
 
-            self.canvas, self._last_canvas = self._last_canvas, self.canvas
+            if track_damage:
+                # Content of a re-clipped gadget may have moved, so all of it is
+                # repainted, else only the portion that was uncovered or covered.
+                if child in reclipped:
+                    self._damage |= old_region | child._region
+                else:
+                    self._damage |= old_region ^ child._region
+
+        if track_damage:
+            self._damage |= self._region ^ visible
+        self._region = visible
+
+    def _lock_geometry(self):
+        """
+        Acquire render lock once no frame is being painted on another thread.
+
+        Painting isn't locked, so gadgets can't be resized or moved while a frame is
+        painted. A new frame can't start painting until the lock is released.
+        """
+        if self._painting_thread == get_ident():
+            self._render_lock.acquire()
+            return
+
+        while True:
+            self._painted.wait()
+            self._render_lock.acquire()
+            if self._painted.is_set():
+                return
+            self._render_lock.release()
+
+    def _unlock_geometry(self):
+        """Release render lock."""
+        self._render_lock.release()
+
+    def _commit(self, gadget: Gadget, buffer: NDArray):
+        """
+        Commit a back buffer of a gadget from any thread. The latest buffer committed
+        replaces the gadget's front buffer at the start of the next frame.
+        """
+        with self._commit_lock:
+            self._commits[gadget] = buffer
+        self._request_frame()
+
+    def _latest_buffer(self, gadget: Gadget, front: NDArray) -> NDArray:
+        """Return the latest buffer committed for gadget or its front buffer."""
+        with self._commit_lock:
+            return self._commits.get(gadget, front)
+
+    def _swap_buffers(self):
+        """Swap committed back buffers into their gadgets."""
+        with self._commit_lock:
+            commits, self._commits = self._commits, {}
+        for gadget, buffer in commits.items():
+            gadget._swap_buffer(buffer)
+
+    def _gadgets_at(self, point: Point) -> Iterator[Gadget]:
+        """Yield gadgets whose region contains point from front to back."""
+        if self._hit_rows is None:
+            self._hit_rows = [[] for _ in range(self.height)]
+            for gadget in self._z_order:
+                for band in gadget._region.bands:
+                    for y in range(band.y1, band.y2):
+                        self._hit_rows[y].append(gadget)
+
+        y, _ = point
+        if 0 <= y < len(self._hit_rows):
+            for gadget in self._hit_rows[y]:
+                if point in gadget._region:
+                    yield gadget
+
+    def dispatch_mouse(self, mouse_event: MouseEvent) -> bool | None:
+        """
+        Dispatch mouse event until handled.
+
+        If :attr:`hit_test_mouse_moves` is true, mouse moves are only dispatched to
+        gadgets under the current or last mouse position (so gadgets can tell when the
+        mouse leaves them), grabbed gadgets, and their ancestors.
+        """
+        last_mouse_pos = self._last_mouse_pos
+        self._last_mouse_pos = mouse_event.position
+        if (
+            not self.hit_test_mouse_moves
+            or mouse_event.event_type is not MouseEventType.MOUSE_MOVE
+        ):
+            return super().dispatch_mouse(mouse_event)
+
+        targets = set()
+        for gadget in chain(
+            self._gadgets_at(last_mouse_pos),
+            self._gadgets_at(mouse_event.position),
+            Grabbable._grabbed,
+        ):
+            while gadget is not None and gadget not in targets:
+                targets.add(gadget)
+                gadget = gadget.parent
 
+        Gadget._mouse_targets = targets
+        try:
+            return super().dispatch_mouse(mouse_event)
+        finally:
+            Gadget._mouse_targets = None
+
+    def _render(self):
+        """
+        Render gadget tree into `canvas`.
+
+        Running tweens are advanced first, so their writes are batched before layout.
+        Committed buffers are swapped in, and layout and regions are computed with the
+        render lock held. Painting only reads front buffers, which are only written on
+        the render thread, so it isn't locked.
+        """
+        self._tween_clock.tick()
+        if self._tween_clock.is_running:
+            self._request_frame()
+
+        start = perf_counter()
+        with self._render_lock:
+            self._swap_buffers()
+            self._apply_layout()
+            self._update_regions()
+            self._update_image_gadgets()
+            self._painted.clear()
+            self._painting_thread = get_ident()
+
+        regions_done = perf_counter()
+        try:
+            self._paint()
+        finally:
+            self._painting_thread = None
+            self._painted.set()
+        self._regions_time = regions_done - start
+        self._paint_time = perf_counter() - regions_done
+
+    def _paint(self):
+        """Paint gadgets into `canvas`. Regions must be up-to-date."""
+        dirty, self._dirty_gadgets = self._dirty_gadgets, set()
+
+        if not self.damage_tracking:
+            self.canvas, self._last_canvas = self._last_canvas, self.canvas
             self.canvas[:] = self._cell
+            self._last_damage = self._clip_region
 
             for child in self.walk():
                 if child.is_enabled and child.is_visible:
                     child._render(self.canvas)
+            return
+
+        damage = self._damage
+        for gadget in dirty:
+            damage |= gadget._region
+        self._damage = Region()
+
+        # Outside of damage, the last frame is kept. Bring last canvas up-to-date with
+        # the last frame before painting.
+        for rect in self._last_damage.rects():
+            self._last_canvas[rect.to_slices()] = self.canvas[rect.to_slices()]
+        self._last_damage = damage
+
+        if not damage:
+            return
+
+        for rect in damage.rects():
+            self.canvas[rect.to_slices()] = self._cell
+
+        for child in self.walk():
+            if child.is_enabled and child.is_visible:
+                region = child._region
+                child._region = region & damage
+                if child._region:
+                    child._render(self.canvas)
+                child._region = region
@@ -0,0 +1,355 @@
+"""Incremental syntax highlighting of lines of text with pygments."""
+import numpy as np
+from numpy.typing import NDArray
+from pygments.lexer import Lexer, RegexLexer
+from pygments.style import Style
+from pygments.token import Error, Whitespace, _TokenType
+
+from ..colors import Color
+from ._text_document import line_width
+from .text_tools import Cell
+
+__all__ = ["SyntaxHighlighter"]
+
+State = tuple[str, ...]
+"""A lexer state stack."""
+
+Runs = tuple[tuple[int, ...], tuple[int, ...]]
+"""Column widths and style ids of the tokens of a line."""
+
+_ROOT: State = ("root",)
+
+
+class _LineBuilder:
+    """Split tokens into the runs of each line."""
+
+    def __init__(self, highlighter: "SyntaxHighlighter", y: int):
+        self.highlighter = highlighter
+        self.y = y
+        """Current line."""
+        self.widths: list[int] = []
+        self.ids: list[int] = []
+        self.old_state: State | None = None
+        """Cached start state of the current line before it was lexed."""
+        self.crossed = False
+        """Whether a line was ended since last checked."""
+
+    def add(self, ttype: _TokenType, value: str):
+        """Add a token to current line, ending the line at each newline."""
+        highlighter = self.highlighter
+        if self.y == len(highlighter._lines):
+            return
+        for i, part in enumerate(value.split("\n")):
+            if i > 0:
+                highlighter._runs[self.y] = tuple(self.widths), tuple(self.ids)
+                self.y += 1
+                self.widths = []
+                self.ids = []
+                self.old_state = highlighter._states[self.y]
+                # Unknown unless the line starts with a token.
+                highlighter._states[self.y] = None
+                self.crossed = True
+                if self.y == len(highlighter._lines):
+                    return
+            if part:
+                self.widths.append(line_width(part))
+                self.ids.append(highlighter._style_id(ttype))
+
+
+class SyntaxHighlighter:
+    """
+    Incrementally lex lines of text and paint their styles into canvases.
+
+    The lexer state stack at the start of each line is cached with the styles of each
+    line. After an edit, lines are re-lexed from the first edited line only until the
+    state at the start of a line matches its cached state. Lexing is lazy: only lines
+    up to the last line painted are lexed.
+
+    Re-lexing starts one line before an edit, so the tokens of a line are assumed to
+    depend on at most the line after it. A multi-line token whose match depends on
+    text further ahead (e.g., a string that was unterminated until a quote was added
+    many lines below) is only re-lexed once an edit reaches the line it starts on.
+
+    Incremental lexing is only supported for regex lexers that don't post-process
+    their tokens (most pygments lexers). For other lexers, all lines are re-lexed
+    after any edit.
+
+    Parameters
+    ----------
+    lexer : Lexer
+        Lexer for text.
+    style : type[Style]
+        A pygments style.
+    lines : list[str]
+        Lines of text. The list may be shared and edited in place if each edit is
+        followed by a call to :meth:`edit`.
+
+    Attributes
+    ----------
+    lexer : Lexer
+        Lexer for text.
+    style : type[Style]
+        A pygments style.
+
+    Methods
+    -------
+    set_lines(lines)
+        Replace all lines, re-lexing only changed lines.
+    edit(start, stop, count)
+        Invalidate lines from `start` to `stop` replaced by `count` lines.
+    paint(canvas, top=0, left=0)
+        Paint styles of lines into a canvas.
+    """
+
+    def __init__(self, lexer: Lexer, style: type[Style], lines: list[str]):
+        self.lexer = lexer
+        self.style = style
+        self._is_incremental = (
+            type(lexer).get_tokens_unprocessed is RegexLexer.get_tokens_unprocessed
+        )
+        self._lines = lines
+        self._states: list[State | None] = [_ROOT, *(None for _ in lines)]
+        """Lexer state at the start of each line, and after the last line."""
+        self._runs: list[Runs | None] = [None] * len(lines)
+        """Styles of each line or None if line needs lexing."""
+        self._style_ids: dict[_TokenType, int] = {}
+        """Index of each token type into style table."""
+        self._token_styles: list[dict] = []
+        """Style of each token type by style id."""
+        self._style_table: tuple[NDArray, ...] | None = None
+        """Style arrays indexed by style id; the last entry is unstyled."""
+
+    def set_lines(self, lines: list[str]):
+        """Replace all lines, re-lexing only lines that changed."""
+        old = self._lines
+        n = min(len(old), len(lines))
+        prefix = 0
+        while prefix < n and old[prefix] == lines[prefix]:
+            prefix += 1
+        suffix = 0
+        while suffix < n - prefix and old[-1 - suffix] == lines[-1 - suffix]:
+            suffix += 1
+
+        self._lines = lines
+        self.edit(prefix, len(old) - suffix, len(lines) - prefix - suffix)
+
+    def edit(self, start: int, stop: int, count: int):
+        """
+        Invalidate lines from `start` to `stop` that were replaced by `count` lines.
+
+        Parameters
+        ----------
+        start : int
+            First replaced line.
+        stop : int
+            Line after last replaced line.
+        count : int
+            Number of new lines.
+        """
+        self._runs[start:stop] = [None] * count
+        if count and start == stop:
+            # Line `start` now follows the inserted lines and keeps its start state,
+            # which is also the start state of the first inserted line.
+            self._states[start + 1 : start + 1] = [None] * (count - 1)
+            self._states.insert(start + count, self._states[start])
+        elif count:
+            self._states[start + 1 : stop] = [None] * (count - 1)
+        else:
+            del self._states[start + 1 : stop + 1]
+            if start < len(self._runs):
+                # The line after the edit may now start in a different state.
+                self._runs[start] = None
+
+    def _style_id(self, ttype: _TokenType) -> int:
+        """Return style id of a token type."""
+        style_id = self._style_ids.get(ttype)
+        if style_id is None:
+            style_id = self._style_ids[ttype] = len(self._token_styles)
+            self._token_styles.append(self.style.style_for_token(ttype))
+            self._style_table = None
+        return style_id
+
+    def _get_style_table(self) -> tuple[NDArray, ...]:
+        """Return style arrays indexed by style id."""
+        if self._style_table is None:
+            styles = [
+                *self._token_styles,
+                {
+                    "color": "",
+                    "bgcolor": "",
+                    "bold": False,
+                    "italic": False,
+                    "underline": False,
+                },
+            ]
+            self._style_table = (
+                np.array([bool(style["color"]) for style in styles]),
+                np.array(
+                    [Color.from_hex(style["color"] or "000000") for style in styles],
+                    np.uint8,
+                ),
+                np.array([bool(style["bgcolor"]) for style in styles]),
+                np.array(
+                    [Color.from_hex(style["bgcolor"] or "000000") for style in styles],
+                    np.uint8,
+                ),
+                np.array([style["bold"] for style in styles], bool),
+                np.array([style["italic"] for style in styles], bool),
+                np.array([style["underline"] for style in styles], bool),
+            )
+        return self._style_table
+
+    def _lex(self, until: int):
+        """Lex lines that need lexing up to line `until`."""
+        runs = self._runs
+        if not self._is_incremental:
+            if None in runs:
+                self._lex_all()
+            return
+
+        states = self._states
+        while True:
+            try:
+                y = runs.index(None)
+            except ValueError:
+                return
+            if y > until:
+                return
+            if y > 0:
+                # The last token of the previous line may depend on this line.
+                y -= 1
+            while states[y] is None:
+                # Line starts inside a multi-line token; lex from the token's start.
+                y -= 1
+            self._lex_from(y, until)
+
+    def _lex_all(self):
+        """Lex all lines."""
+        lines = self._lines
+        self._runs[:] = [None] * len(lines)
+        builder = _LineBuilder(self, 0)
+        if lines:
+            text = "\n".join(lines) + "\n"
+            for _, ttype, value in self.lexer.get_tokens_unprocessed(text):
+                builder.add(ttype, value)
+                if builder.y == len(lines):
+                    break
+        for y in range(builder.y, len(lines)):
+            self._runs[y] = tuple(builder.widths), tuple(builder.ids)
+            builder.widths = builder.ids = []
+
+    def _lex_from(self, y: int, until: int):
+        """
+        Lex from line `y` until the state at the start of a line matches its cached
+        state, or past line `until`.
+
+        This is pygments' ``RegexLexer.get_tokens_unprocessed`` with the state stack
+        checked at each line.
+        """
+        lexer = self.lexer
+        lines = self._lines
+        runs = self._runs
+        states = self._states
+        nlines = len(lines)
+
+        text = "\n".join(lines[y:]) + "\n"
+        tokendefs = lexer._tokens
+        statestack = list(states[y])
+        statetokens = tokendefs[statestack[-1]]
+        builder = _LineBuilder(self, y)
+        pos = 0
+
+        while True:
+            for rexmatch, action, new_state in statetokens:
+                m = rexmatch(text, pos)
+                if m:
+                    if action is not None:
+                        if type(action) is _TokenType:
+                            builder.add(action, m.group())
+                        else:
+                            for _, ttype, value in action(lexer, m):
+                                builder.add(ttype, value)
+                    pos = m.end()
+                    if new_state is not None:
+                        if isinstance(new_state, tuple):
+                            for state in new_state:
+                                if state == "#pop":
+                                    if len(statestack) > 1:
+                                        statestack.pop()
+                                elif state == "#push":
+                                    statestack.append(statestack[-1])
+                                else:
+                                    statestack.append(state)
+                        elif isinstance(new_state, int):
+                            if abs(new_state) >= len(statestack):
+                                del statestack[1:]
+                            else:
+                                del statestack[new_state:]
+                        elif new_state == "#push":
+                            statestack.append(statestack[-1])
+                        statetokens = tokendefs[statestack[-1]]
+                    break
+            else:
+                if pos >= len(text):
+                    return
+                if text[pos] == "\n":
+                    statestack = ["root"]
+                    statetokens = tokendefs["root"]
+                    builder.add(Whitespace, "\n")
+                else:
+                    builder.add(Error, text[pos])
+                pos += 1
+
+            if not builder.crossed:
+                continue
+            builder.crossed = False
+
+            line = builder.y
+            if line == nlines:
+                states[line] = tuple(statestack)
+                return
+            if text[pos - 1] != "\n":
+                continue  # Line starts inside a token.
+
+            state = tuple(statestack)
+            states[line] = state
+            if state == builder.old_state and runs[line] is not None:
+                return  # Converged; following lines are unchanged.
+            if line > until:
+                runs[line] = None
+                return
+
+    def paint(self, canvas: NDArray[Cell], top: int = 0, left: int = 0):
+        """
+        Paint styles of lines into a canvas.
+
+        Only lines visible in the canvas are lexed (if needed) and painted. Colors of
+        cells without a token color are unchanged.
+
+        Parameters
+        ----------
+        canvas : NDArray[Cell]
+            Canvas to paint.
+        top : int, default: 0
+            Line painted in the first row of the canvas.
+        left : int, default: 0
+            Column painted in the first column of the canvas.
+        """
+        h, w = canvas.shape
+        bottom = min(top + h, len(self._lines))
+        self._lex(bottom - 1)
+
+        ids = np.full((h, w), -1)
+        for i, y in enumerate(range(top, bottom)):
+            widths, styles = self._runs[y]
+            row = np.repeat(styles, widths)[left : left + w]
+            ids[i, : len(row)] = row
+
+        has_fg, fg, has_bg, bg, bold, italic, underline = self._get_style_table()
+        mask = has_fg[ids]
+        canvas["fg_color"][mask] = fg[ids[mask]]
+        mask = has_bg[ids]
+        canvas["bg_color"][mask] = bg[ids[mask]]
+        canvas["bold"] = bold[ids]
+        canvas["italic"] = italic[ids]
+        canvas["underline"] = underline[ids]
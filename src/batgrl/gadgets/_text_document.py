@@ -0,0 +1,235 @@
+"""Line-indexed text storage for editable text gadgets."""
+from collections import Counter
+from typing import NamedTuple
+
+from ..geometry import Point
+from .text_tools import char_width, str_width
+
+__all__ = ["Edit", "TextDocument", "column_index", "line_cells", "line_width"]
+
+
+def _is_narrow(line: str) -> bool:
+    """Whether every character of a line is one column wide."""
+    return line.isascii() and line.isprintable()
+
+
+def line_width(line: str) -> int:
+    """Return the column width of a line."""
+    return str_width(line)
+
+
+def column_index(line: str, column: int) -> int:
+    """Return the index of the first character of a line at or after `column`."""
+    if _is_narrow(line):
+        return min(column, len(line))
+
+    x = 0
+    for i, char in enumerate(line):
+        if x >= column:
+            return i
+        x += char_width(char)
+    return len(line)
+
+
+def line_cells(line: str, start: int, stop: int) -> list[str]:
+    """
+    Return the characters of each cell of a line from column `start` to `stop`.
+
+    The cell after a full-width character is ``""``. Zero-width characters are
+    dropped.
+    """
+    if _is_narrow(line):
+        return list(line[start:stop])
+
+    cells = []
+    for char in line:
+        width = char_width(char)
+        if width == 0:
+            continue
+        cells.append(char)
+        if width == 2:
+            cells.append("")
+        if len(cells) >= stop:
+            break
+
+    cells = cells[start:stop]
+    if cells and cells[0] == "":  # Full-width character clipped at start.
+        cells[0] = " "
+    return cells
+
+
+class Edit(NamedTuple):
+    """
+    An insertion or deletion of text.
+
+    An edit holds only the text inserted or deleted, and is undone by applying the
+    opposite edit.
+    """
+
+    start: Point | int
+    """Start of edited text."""
+    end: Point | int
+    """End of edited text."""
+    text: str
+    """Inserted or deleted text."""
+    is_insertion: bool
+    """Whether text was inserted or deleted."""
+    selection_start: Point | int | None
+    """Start of selection before edit."""
+    selection_end: Point | int | None
+    """End of selection before edit."""
+    cursor: Point | int
+    """Cursor before edit."""
+
+
+class TextDocument:
+    """
+    Text stored as a list of lines with the column width of each line.
+
+    Lines are immutable strings, so an edit only rebuilds the lines it touches and a
+    multi-line insert or delete is a single list splice. A count of line widths keeps
+    the widest line without rescanning the document. Positions are (line, column)
+    points where column is measured in cells, not characters.
+
+    Methods
+    -------
+    line(y)
+        Return a line of the document.
+    width(y)
+        Return column width of a line.
+    char(pos)
+        Return the character at a position.
+    insert(pos, text)
+        Insert text and return the end of inserted text.
+    delete(start, end)
+        Delete text and return the deleted text.
+    """
+
+    def __init__(self):
+        self._lines: list[str] = [""]
+        """Lines of document."""
+        self._widths: list[int] = [0]
+        """Column width of each line."""
+        self._width_counts: Counter[int] = Counter({0: 1})
+        """Number of lines of each width."""
+        self._max_width = 0
+        """Width of widest line."""
+
+    def __len__(self) -> int:
+        return len(self._lines)
+
+    @property
+    def text(self) -> str:
+        """Text of document."""
+        return "\n".join(self._lines)
+
+    @property
+    def lines(self) -> list[str]:
+        """Lines of document. Edited in place; must not be modified."""
+        return self._lines
+
+    @property
+    def max_width(self) -> int:
+        """Width of widest line."""
+        return self._max_width
+
+    @property
+    def end(self) -> Point:
+        """Point after last character in document."""
+        return Point(len(self._lines) - 1, self._widths[-1])
+
+    def line(self, y: int) -> str:
+        """Return a line of the document."""
+        return self._lines[y]
+
+    def width(self, y: int) -> int:
+        """Return column width of a line."""
+        return self._widths[y]
+
+    def char(self, pos: Point) -> str:
+        """Return the character at a position or a space if past end of line."""
+        y, x = pos
+        line = self._lines[y]
+        i = column_index(line, x)
+        return line[i] if i < len(line) else " "
+
+    def _replace_lines(self, start: int, stop: int, lines: list[str]):
+        """Replace lines from `start` to `stop` and update widths."""
+        counts = self._width_counts
+        for width in self._widths[start:stop]:
+            counts[width] -= 1
+            if counts[width] == 0:
+                del counts[width]
+
+        widths = [line_width(line) for line in lines]
+        counts.update(widths)
+        self._lines[start:stop] = lines
+        self._widths[start:stop] = widths
+
+        new_max = max(widths, default=0)
+        if new_max >= self._max_width:
+            self._max_width = new_max
+        elif self._max_width not in counts:
+            self._max_width = max(counts)
+
+    def insert(self, pos: Point, text: str) -> Point:
+        """
+        Insert text at a position.
+
+        Parameters
+        ----------
+        pos : Point
+            Where text is inserted.
+        text : str
+            Text to insert.
+
+        Returns
+        -------
+        Point
+            End of inserted text.
+        """
+        y, x = pos
+        line = self._lines[y]
+        i = column_index(line, x)
+        head, tail = line[:i], line[i:]
+
+        lines = text.split("\n")  # DO NOT USE `splitlines`.
+        last_width = line_width(lines[-1])
+        if len(lines) == 1:
+            end = Point(y, x + last_width)
+        else:
+            end = Point(y + len(lines) - 1, last_width)
+        lines[0] = head + lines[0]
+        lines[-1] += tail
+        self._replace_lines(y, y + 1, lines)
+        return end
+
+    def delete(self, start: Point, end: Point) -> str:
+        """
+        Delete text from `start` to `end`.
+
+        Parameters
+        ----------
+        start : Point
+            Start of deleted text.
+        end : Point
+            End of deleted text.
+
+        Returns
+        -------
+        str
+            The deleted text.
+        """
+        sy, sx = start
+        ey, ex = end
+        first = self._lines[sy]
+        last = self._lines[ey]
+        i = column_index(first, sx)
+        j = column_index(last, ex)
+
+        if sy == ey:
+            deleted = first[i:j]
+        else:
+            deleted = "\n".join([first[i:], *self._lines[sy + 1 : ey], last[:j]])
+        self._replace_lines(sy, ey + 1, [first[:i] + last[j:]])
+        return deleted
@@ -0,0 +1,174 @@
+"""A clock that advances all running tweens once per frame."""
+import asyncio
+from collections.abc import Callable
+from dataclasses import dataclass
+from time import monotonic
+from typing import Any
+
+import numpy as np
+
+from ..easings import Easing, ease_array
+from .gadget import Gadget
+
+__all__ = ["TweenClock"]
+
+
+@dataclass(eq=False)
+class _Tween:
+    """A running tween of gadget properties."""
+
+    gadget: Gadget
+    """The tweened gadget."""
+    start_time: float
+    """Start time of tween."""
+    duration: float
+    """Duration of tween in seconds."""
+    easing: Easing
+    """Easing of tween."""
+    start_values: tuple[Any, ...]
+    """Initial values of tweened properties."""
+    properties: dict[str, Any]
+    """Target values of tweened properties."""
+    on_progress: Callable[[float], None] | None
+    """Called as tween updates with current progress."""
+    done: asyncio.Future
+    """Resolved when tween completes."""
+
+
+class TweenClock:
+    """
+    Advances all running tweens in one tick per frame.
+
+    Tweens are eased together (one array per easing) and their property writes are
+    made back-to-back before layout, so geometry changes of all tweens are applied in
+    a single layout and regions pass. Callbacks bound to tweened properties are called
+    once per tick, after all writes. An error in a bound callback is raised in the
+    tweens that set the property.
+
+    Methods
+    -------
+    add(gadget, duration, easing, start_values, properties, on_progress)
+        Start a tween. Return a future resolved when the tween completes.
+    tick()
+        Advance all running tweens.
+    """
+
+    def __init__(self):
+        self._tweens: list[_Tween] = []
+        """Running tweens in order of start."""
+
+    @property
+    def is_running(self) -> bool:
+        """Whether any tweens are running."""
+        return bool(self._tweens)
+
+    def add(
+        self,
+        gadget: Gadget,
+        duration: float,
+        easing: Easing,
+        start_values: tuple[Any, ...],
+        properties: dict[str, Any],
+        on_progress: Callable[[float], None] | None = None,
+    ) -> asyncio.Future:
+        """
+        Start a tween. Return a future resolved when the tween completes.
+
+        A frame is requested so the tween starts ticking even if the app renders on
+        demand. Cancelling the future stops the tween.
+        """
+        done = asyncio.get_running_loop().create_future()
+        self._tweens.append(
+            _Tween(
+                gadget,
+                monotonic(),
+                duration,
+                easing,
+                start_values,
+                properties,
+                on_progress,
+                done,
+            )
+        )
+        gadget._request_frame()
+        return done
+
+    def tick(self):
+        """Advance all running tweens."""
+        tweens = [tween for tween in self._tweens if not tween.done.done()]
+        self._tweens = []
+        if not tweens:
+            return
+
+        now = monotonic()
+        ps = np.array(
+            [(now - tween.start_time) / tween.duration for tween in tweens]
+        ).clip(0, 1)
+
+        by_easing: dict[Easing, list[int]] = {}
+        for i, tween in enumerate(tweens):
+            by_easing.setdefault(tween.easing, []).append(i)
+        eased = np.empty_like(ps)
+        for easing, indices in by_easing.items():
+            eased[indices] = ease_array(easing, ps[indices])
+
+        running = []
+        finished = []
+        deferred: dict[int, Callable[[], None]] = {}
+        # Tweens that set a bound property, by uid of binding.
+        owners: dict[int, list[_Tween]] = {}
+        try:
+            for tween, p, eased_p in zip(tweens, ps.tolist(), eased.tolist()):
+                gadget = tween.gadget
+                bindings = Gadget._deferred_bindings = {}
+                try:
+                    if p < 1:
+                        for start_value, (prop, target) in zip(
+                            tween.start_values, tween.properties.items()
+                        ):
+                            value = Gadget._tween_lerp(start_value, target, eased_p)
+                            setattr(gadget, prop, value)
+                        if tween.on_progress is not None:
+                            tween.on_progress(eased_p)
+                    else:
+                        for prop, target in tween.properties.items():
+                            setattr(gadget, prop, target)
+                except Exception as e:
+                    tween.done.set_exception(e)
+                    continue
+                finally:
+                    deferred.update(bindings)
+                    for uid in bindings:
+                        owners.setdefault(uid, []).append(tween)
+
+                if p < 1:
+                    running.append(tween)
+                else:
+                    finished.append(tween)
+        finally:
+            Gadget._deferred_bindings = None
+            # Tweens started during the tick run after the tweens that were running.
+            self._tweens[:0] = running
+
+        for uid, callback in deferred.items():
+            try:
+                callback()
+            except Exception as e:
+                self._deliver(e, owners[uid])
+
+        for tween in finished:
+            if not tween.done.done():
+                tween.done.set_result(None)
+
+    def _deliver(self, error: Exception, tweens: list[_Tween]):
+        """
+        Raise an error of a bound callback in the tweens that set the bound property,
+        or pass it to the event loop's exception handler if they are all done.
+        """
+        pending = [tween for tween in tweens if not tween.done.done()]
+        for tween in pending:
+            tween.done.set_exception(error)
+        if not pending:
+            asyncio.get_running_loop().call_exception_handler(
+                {"message": "Exception in bound callback of tween", "exception": error}
+            )
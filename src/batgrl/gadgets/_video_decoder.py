@@ -0,0 +1,309 @@
+"""Threaded video decoding shared between video gadgets."""
+import asyncio
+import atexit
+import time
+from collections import deque
+from collections.abc import Callable
+from pathlib import Path
+from threading import Condition, Thread
+from typing import Any
+
+import cv2
+from numpy.typing import NDArray
+
+__all__ = ["VideoStream", "open_stream"]
+
+MAX_BUFFERED_FRAMES = 3
+"""Max prepared frames buffered for each stream."""
+
+Prepare = Callable[[NDArray], Any]
+"""Prepares a decoded BGR frame for display. Called from the decode thread."""
+
+_DECODERS: dict[str | int, "_VideoDecoder"] = {}
+"""Open decoders by source."""
+
+
+def open_stream(source: Path | str | int, prepare: Prepare) -> "VideoStream":
+    """
+    Open a stream of prepared frames from a video source.
+
+    All streams of the same source share a decoder, so frames are decoded once, and
+    seeking one stream seeks all of them. The decoder runs while any stream plays.
+
+    Parameters
+    ----------
+    source : Path | str | int
+        A path to video, URL to video stream, or video capturing device (by index).
+    prepare : Prepare
+        Called from the decode thread with each decoded BGR frame. Its return value is
+        what the stream yields.
+
+    Returns
+    -------
+    VideoStream
+        A new stream from the source.
+    """
+    key = str(source.absolute()) if isinstance(source, Path) else source
+    if (decoder := _DECODERS.get(key)) is None:
+        decoder = _DECODERS[key] = _VideoDecoder(key)
+    return VideoStream(decoder, prepare)
+
+
+class VideoStream:
+    """
+    A stream of prepared frames from a shared decoder.
+
+    Parameters
+    ----------
+    decoder : _VideoDecoder
+        The decoder of the stream.
+    prepare : Prepare
+        Prepares decoded frames for display.
+
+    Attributes
+    ----------
+    is_device : bool
+        Whether source is a video capturing device.
+    is_playing : bool
+        Whether stream is being decoded.
+
+    Methods
+    -------
+    play()
+        Start decoding.
+    pause()
+        Stop decoding.
+    seek(time)
+        Seek to certain time (in seconds) for all streams of the source.
+    seconds_ahead(pts)
+        Seconds until a frame with presentation time `pts` is due.
+    next_frame()
+        Wait for the next frame.
+    close()
+        Close stream.
+    """
+
+    def __init__(self, decoder: "_VideoDecoder", prepare: Prepare):
+        self._decoder = decoder
+        self._prepare = prepare
+        self._frames: deque[tuple[float, Any] | None] = deque()
+        self._loop: asyncio.AbstractEventLoop | None = None
+        self._ready: asyncio.Event | None = None
+        self.is_playing = False
+        decoder.add_stream(self)
+
+    @property
+    def is_device(self) -> bool:
+        """Whether source is a video capturing device."""
+        return self._decoder.is_device
+
+    def play(self):
+        """Start decoding. Must be called from a running event loop."""
+        self._loop = asyncio.get_running_loop()
+        self._ready = asyncio.Event()
+        self._decoder.play_stream(self)
+
+    def pause(self):
+        """Stop decoding."""
+        self._decoder.pause_stream(self)
+
+    def seek(self, time: float):
+        """Seek to certain time (in seconds) for all streams of the source."""
+        self._decoder.seek(time)
+
+    def seconds_ahead(self, pts: float) -> float:
+        """Seconds until a frame with presentation time `pts` is due."""
+        return self._decoder.seconds_ahead(pts)
+
+    async def next_frame(self) -> tuple[float, Any] | None:
+        """
+        Wait for the next frame.
+
+        Late frames are dropped if a newer frame is buffered.
+
+        Returns
+        -------
+        tuple[float, Any] | None
+            The presentation time of the frame and the prepared frame, or None if the
+            end of the video was reached.
+        """
+        decoder = self._decoder
+        while True:
+            with decoder.condition:
+                while len(self._frames) > 1 and self._frames[0] is not None:
+                    pts, _ = self._frames[0]
+                    if decoder.seconds_ahead(pts) >= 0:
+                        break
+                    self._frames.popleft()
+
+                if self._frames:
+                    item = self._frames.popleft()
+                    if item is not None:
+                        decoder.position = item[0]
+                    decoder.condition.notify()
+                    return item
+
+                self._ready.clear()
+            await self._ready.wait()
+
+    def _push(self, item: tuple[float, Any] | None):
+        """Buffer a frame, or None at the end of the video. Called with lock held."""
+        self._frames.append(item)
+        try:
+            self._loop.call_soon_threadsafe(self._ready.set)
+        except RuntimeError:  # Event loop is closed.
+            pass
+
+    def close(self):
+        """Close stream. The decoder is closed with its last stream."""
+        self.pause()
+        self._decoder.remove_stream(self)
+
+
+class _VideoDecoder:
+    """Decode a video source in a background thread for one or more streams."""
+
+    def __init__(self, key: str | int):
+        self.key = key
+        self.is_device = isinstance(key, int)
+        self.condition = Condition()
+        self.streams: list[VideoStream] = []
+        self.position = 0.0
+        """Presentation time of last frame taken by a stream."""
+        self._start_time = 0.0
+        self._seek_to: float | None = None
+        self._generation = 0
+        """Incremented on seek so frames decoded before the seek are discarded."""
+        self._at_end = False
+        self._closed = False
+        self._capture = cv2.VideoCapture(key)
+        atexit.register(self._close_at_exit)
+        self._thread = Thread(
+            target=self._decode, daemon=True, name="batgrl-video-decoder"
+        )
+        self._thread.start()
+
+    def _time_delta(self, pts: float) -> float:
+        return time.monotonic() - pts
+
+    def seconds_ahead(self, pts: float) -> float:
+        """Seconds until a frame with presentation time `pts` is due."""
+        if self.is_device:
+            return 0
+        return self._start_time - self._time_delta(pts)
+
+    def add_stream(self, stream: VideoStream):
+        with self.condition:
+            self.streams.append(stream)
+
+    def remove_stream(self, stream: VideoStream):
+        with self.condition:
+            self.streams.remove(stream)
+            if self.streams:
+                return
+        self.close()
+
+    def play_stream(self, stream: VideoStream):
+        with self.condition:
+            if any(other.is_playing for other in self.streams):
+                # Buffered frames are behind the other streams.
+                stream._frames.clear()
+            else:
+                # Resume from where playback stopped.
+                self._start_time = self._time_delta(self.position)
+            stream.is_playing = True
+            self.condition.notify()
+
+    def pause_stream(self, stream: VideoStream):
+        with self.condition:
+            stream.is_playing = False
+
+    def seek(self, time: float):
+        if self.is_device:
+            return
+
+        with self.condition:
+            self._seek_to = time
+            self._generation += 1
+            self._at_end = False
+            self.position = time
+            self._start_time = self._time_delta(time)
+            for stream in self.streams:
+                stream._frames.clear()
+            self.condition.notify()
+
+    def _can_decode(self) -> bool:
+        """Whether a stream is playing and every playing stream has buffer space."""
+        playing = [stream for stream in self.streams if stream.is_playing]
+        return (
+            bool(playing)
+            and not self._at_end
+            and all(len(stream._frames) < MAX_BUFFERED_FRAMES for stream in playing)
+        )
+
+    def _decode(self):
+        """
+        Decode frames while any stream is playing and release capture once closed.
+        Runs in the decode thread.
+        """
+        try:
+            self._decode_frames()
+        finally:
+            self._capture.release()
+
+    def _decode_frames(self):
+        """Decode frames while any stream is playing until closed."""
+        capture = self._capture
+        while True:
+            with self.condition:
+                self.condition.wait_for(lambda: self._closed or self._can_decode())
+                if self._closed:
+                    return
+                if self._seek_to is not None:
+                    capture.set(cv2.CAP_PROP_POS_MSEC, self._seek_to * 1000)
+                    self._seek_to = None
+                generation = self._generation
+
+            if not capture.grab():
+                with self.condition:
+                    if generation == self._generation:
+                        self._at_end = True
+                        for stream in self.streams:
+                            if stream.is_playing:
+                                stream._push(None)
+                continue
+
+            pts = capture.get(cv2.CAP_PROP_POS_MSEC) / 1000
+            if self.seconds_ahead(pts) < 0:
+                continue  # Too late to show; skip retrieving and preparing it.
+
+            _, frame = capture.retrieve()
+            with self.condition:
+                playing = [stream for stream in self.streams if stream.is_playing]
+            prepared = [(stream, stream._prepare(frame)) for stream in playing]
+
+            with self.condition:
+                if generation != self._generation:
+                    continue
+                for stream, item in prepared:
+                    if stream.is_playing:
+                        stream._push((pts, item))
+
+    def close(self):
+        """
+        Stop decoding. The decode thread releases the capture once it stops, so this
+        doesn't wait for a frame being decoded.
+        """
+        with self.condition:
+            if self._closed:
+                return
+            self._closed = True
+            self.condition.notify()
+        atexit.unregister(self._close_at_exit)
+        if _DECODERS.get(self.key) is self:
+            del _DECODERS[self.key]
+
+    def _close_at_exit(self):
+        """Stop decoding and give the decode thread a moment to release capture."""
+        self.close()
+        self._thread.join(timeout=1)
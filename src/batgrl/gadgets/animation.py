@@ -1,8 +1,11 @@
 """An animation gadget."""
 import asyncio
 from collections.abc import Iterable, Sequence
+from concurrent.futures import Future, ThreadPoolExecutor
 from pathlib import Path
+from threading import Lock
 
+import cv2
 import numpy as np
 from numpy.typing import NDArray
 
@@ -20,26 +23,88 @@ from .gadget import (
     clamp,
 )
 from .image import Image, Interpolation
+from .texture_tools import resize_texture, texture_cache
 
 __all__ = ["Animation", "Interpolation", "Point", "Size"]
 
+_PREFETCH_EXECUTOR = ThreadPoolExecutor(1, thread_name_prefix="batgrl-animation")
+"""Decodes and resizes frames of streaming animations."""
+
 
 def _check_frame_durations(
-    frames: list[Image], frame_durations: float | Sequence[float]
+    nframes: int, frame_durations: float | Sequence[float]
 ) -> Sequence[float]:
     """
-    Raise `ValueError` if `frames` and `frame_durations` are incompatible,
+    Raise `ValueError` if `nframes` and `frame_durations` are incompatible,
     else return a sequence of frame durations.
     """
     if isinstance(frame_durations, float):
-        return [frame_durations] * len(frames)
+        return [frame_durations] * nframes
 
-    if len(frame_durations) != len(frames):
+    if len(frame_durations) != nframes:
         raise ValueError("number of frames doesn't match number of frame durations")
 
     return frame_durations
 
 
+class _ImageFiles:
+    """Frames of an animation from a sequence of image paths."""
+
+    def __init__(self, paths: list[Path]):
+        self.paths = paths
+
+    def __len__(self) -> int:
+        return len(self.paths)
+
+    def read(self, i: int) -> NDArray[np.uint8]:
+        """Return an RGBA texture of the `i`-th frame."""
+        return texture_cache.get(self.paths[i])
+
+
+class _Container:
+    """Frames of an animation from a single animated image or video file."""
+
+    def __init__(self, path: Path):
+        self._path = str(path.absolute())
+        self._capture: cv2.VideoCapture | None = cv2.VideoCapture(self._path)
+        """Capture of the file, reopened if read after release."""
+        self._lock = Lock()
+        self._next = 0
+        """Index of the frame the capture will read next."""
+        self._len = int(self._capture.get(cv2.CAP_PROP_FRAME_COUNT))
+        if self._len <= 0:  # Frame count isn't known for every format; count frames.
+            self._len = 0
+            while self._capture.grab():
+                self._len += 1
+            self._capture.set(cv2.CAP_PROP_POS_FRAMES, 0)
+
+    def __len__(self) -> int:
+        return self._len
+
+    def read(self, i: int) -> NDArray[np.uint8]:
+        """Return an RGBA texture of the `i`-th frame."""
+        with self._lock:
+            if self._capture is None:
+                self._capture = cv2.VideoCapture(self._path)
+                self._next = 0
+            # Frames are usually read in order; only seek if they aren't.
+            if i != self._next:
+                self._capture.set(cv2.CAP_PROP_POS_FRAMES, i)
+            ok, frame = self._capture.read()
+            self._next = i + 1
+
+        if not ok:
+            return np.zeros((1, 1, 4), np.uint8)
+        return cv2.cvtColor(frame, cv2.COLOR_BGR2RGBA)
+
+    def release(self):
+        """Release the capture."""
+        with self._lock:
+            if self._capture is not None:
+                self._capture.release()
+                self._capture = None
+
+
 class Animation(Gadget):
     r"""
     An animation gadget.
@@ -48,7 +113,8 @@ class Animation(Gadget):
     ----------
     path : Path | None, default: None
         Path to directory of images for frames in the animation (loaded
-        in lexographical order of filenames).
+        in lexographical order of filenames), or path to a single animated image or
+        video file (e.g., a GIF, APNG, or MP4).
     frame_durations : float | Sequence[float], default: 1/12
         Time each frame is displayed. If a sequence is provided, it's length should be
         equal to number of frames.
@@ -56,6 +122,11 @@ class Animation(Gadget):
         If true, restart animation after last frame.
     reverse : bool, default: False
         If true, play animation in reverse.
+    stream : bool, default: False
+        If true, frames from `path` are decoded and resized as they are needed instead
+        of all at once, and only the next few frames are kept in memory.
+    prefetch : int, default: 4
+        Number of upcoming frames decoded in the background if streaming.
     alpha : float, default: 1.0
         Transparency of gadget.
     interpolation : Interpolation, default: "linear"
@@ -80,7 +151,7 @@ class Animation(Gadget):
     Attributes
     ----------
     frames : list[Image]
-        Frames of the animation.
+        Frames of the animation. Empty if streaming.
     frame_durations : list[int | float]
         Time each frame is displayed.
     loop : bool
@@ -176,6 +247,8 @@ class Animation(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -205,6 +278,8 @@ class Animation(Gadget):
         frame_durations: float | Sequence[float] = 1 / 12,
         loop: bool = True,
         reverse: bool = False,
+        stream: bool = False,
+        prefetch: int = 4,
         alpha: float = 1.0,
         interpolation: Interpolation = "linear",
         size: Size = Size(10, 10),
@@ -216,7 +291,15 @@ class Animation(Gadget):
         is_enabled: bool = True,
     ):
         self.frames: list[Image] = []
-        """Frames of the animation."""
+        """Frames of the animation. Empty if streaming."""
+        self._source: _ImageFiles | _Container | None = None
+        """Source of frames if streaming."""
+        self._frame: Image | None = None
+        """The displayed frame if streaming."""
+        self._prefetched: dict[int, Future[NDArray[np.uint8]]] = {}
+        self._shown = True
+        """Whether the current frame is displayed."""
+        self._prefetch = prefetch
 
         super().__init__(
             size=size,
@@ -228,19 +311,102 @@ class Animation(Gadget):
             is_enabled=is_enabled,
         )
 
-        if path is not None:
+        if path is None:
+            pass
+        elif path.is_dir():
             paths = sorted(path.iterdir(), key=lambda file: file.name)
-            self.frames = [Image(path=path, size=self.size) for path in paths]
-            for frame in self.frames:
-                frame.parent = self
+            if stream:
+                self._source = _ImageFiles(paths)
+            else:
+                self.frames = [Image(path=path, size=self.size) for path in paths]
+        else:
+            container = _Container(path)
+            if stream:
+                self._source = container
+            else:
+                self.frames = [
+                    Image.from_texture(container.read(i), size=self.size)
+                    for i in range(len(container))
+                ]
+                container.release()
+
+        if self._source is not None:
+            self._frame = Image(size=self.size)
+            self._frame.parent = self
+        for frame in self.frames:
+            frame.parent = self
 
-        self.frame_durations = _check_frame_durations(self.frames, frame_durations)
+        self.frame_durations = _check_frame_durations(self._nframes, frame_durations)
         self.alpha = alpha
         self.interpolation = interpolation
         self.loop = loop
         self.reverse = reverse
-        self._i = len(self.frames) - 1 if self.reverse else 0
+        self._i = self._nframes - 1 if self.reverse else 0
         self._animation_task = None
+        if self._source is not None:
+            self._show_frame()
+
+    @property
+    def _nframes(self) -> int:
+        """Number of frames in the animation."""
+        if self._source is None:
+            return len(self.frames)
+        return len(self._source)
+
+    @property
+    def _images(self) -> list[Image]:
+        """Frames or, if streaming, the displayed frame."""
+        if self._frame is None:
+            return self.frames
+        return [self._frame]
+
+    def _prepare_frame(self, i: int) -> NDArray[np.uint8]:
+        """Decode and resize a frame. Called from the prefetch thread."""
+        h, w = self._size
+        return resize_texture(self._source.read(i), (2 * h, w), self._interpolation)
+
+    def _show_frame(self, block: bool = True):
+        """
+        Display the current frame and prefetch the frames after it if streaming.
+
+        If not `block` and the current frame is still being prefetched, the displayed
+        frame is kept and `_shown` is false until this is called again.
+        """
+        self._shown = True
+        if self._source is None:
+            self.mark_dirty()
+            return
+
+        if (nframes := self._nframes) == 0:
+            return
+
+        future = self._prefetched.get(self._i)
+        if future is not None and not future.done() and not block:
+            self._shown = False
+            return
+
+        h, w = self._size
+        self._prefetched.pop(self._i, None)
+        if future is not None and future.done() and not future.cancelled():
+            texture = future.result()
+        else:
+            texture = None
+        if texture is None or texture.shape[:2] != (2 * h, w):
+            texture = self._prepare_frame(self._i)
+        self._frame.texture = texture
+
+        step = -1 if self.reverse else 1
+        window = {(self._i + step * n) % nframes for n in range(1, self._prefetch + 1)}
+        for i in self._prefetched.keys() - window:
+            self._prefetched.pop(i).cancel()
+        for i in window - self._prefetched.keys():
+            self._prefetched[i] = _PREFETCH_EXECUTOR.submit(self._prepare_frame, i)
+
+    def _clear_prefetched(self):
+        """Cancel all prefetched frames."""
+        for future in self._prefetched.values():
+            future.cancel()
+        self._prefetched.clear()
 
     @property
     def _region(self) -> Region:
@@ -250,19 +416,26 @@ class Animation(Gadget):
     @_region.setter
     def _region(self, region: Region):
         self._region_value = region
-        for frame in self.frames:
+        for frame in self._images:
             frame._region = region
 
     def on_remove(self):
-        """Pause animation."""
+        """Pause animation and release any streamed container."""
         self.pause()
+        self._clear_prefetched()
+        if isinstance(self._source, _Container):
+            self._source.release()
         super().on_remove()
 
     def on_size(self):
         """Update size of all frames on resize."""
-        for frame in self.frames:
+        for frame in self._images:
             frame.size = self._size
 
+        if self._source is not None:
+            self._clear_prefetched()
+            self._show_frame()
+
     @property
     def is_transparent(self) -> bool:
         """Whether gadget is transparent."""
@@ -271,7 +444,8 @@ class Animation(Gadget):
     @is_transparent.setter
     def is_transparent(self, transparent: bool):
         self._is_transparent = transparent
-        for frame in self.frames:
+        self._invalidate_regions()
+        for frame in self._images:
             frame.is_transparent = True
 
     @property
@@ -283,7 +457,7 @@ class Animation(Gadget):
     @bindable
     def alpha(self, alpha: float):
         self._alpha = clamp(float(alpha), 0.0, 1.0)
-        for frame in self.frames:
+        for frame in self._images:
             frame.alpha = alpha
 
     @property
@@ -294,31 +468,37 @@ class Animation(Gadget):
     @interpolation.setter
     def interpolation(self, interpolation: Interpolation):
         self._interpolation = interpolation
-        for frame in self.frames:
+        for frame in self._images:
             frame.interpolation = interpolation
 
     async def _play_animation(self):
-        while self.frames:
+        while self._nframes:
             try:
                 await asyncio.sleep(self.frame_durations[self._i])
             except asyncio.CancelledError:
                 return
 
+            if not self._shown:  # Current frame wasn't decoded in time; retry.
+                self._show_frame(block=False)
+                continue
+
             if self.reverse:
                 self._i -= 1
                 if self._i < 0:
-                    self._i = len(self.frames) - 1
+                    self._i = self._nframes - 1
 
                     if not self.loop:
                         return
             else:
                 self._i += 1
-                if self._i == len(self.frames):
+                if self._i == self._nframes:
                     self._i = 0
 
                     if not self.loop:
                         return
 
+            self._show_frame(block=False)
+
     def play(self) -> asyncio.Task:
         """
         Play animation.
@@ -331,9 +511,11 @@ class Animation(Gadget):
         self.pause()
 
         if self._i == 0 and self.reverse:
-            self._i = len(self.frames) - 1
-        elif self._i == len(self.frames) - 1 and not self.reverse:
+            self._i = self._nframes - 1
+            self._show_frame()
+        elif self._i == self._nframes - 1 and not self.reverse:
             self._i = 0
+            self._show_frame()
 
         self._animation_task = asyncio.create_task(self._play_animation())
         return self._animation_task
@@ -346,11 +528,14 @@ class Animation(Gadget):
     def stop(self):
         """Stop the animation and reset current frame."""
         self.pause()
-        self._i = len(self.frames) - 1 if self.reverse else 0
+        self._i = self._nframes - 1 if self.reverse else 0
+        self._show_frame()
 
     def _render(self, canvas: NDArray[Cell]):
         """Render visible region of gadget."""
-        if self.frames:
+        if self._frame is not None and self._nframes:
+            self._frame._render(canvas)
+        elif self.frames:
             self.frames[self._i]._render(canvas)
         else:
             super()._render(canvas)
@@ -438,7 +623,7 @@ class Animation(Gadget):
         for frame in animation.frames:
             frame.parent = animation
         animation.frame_durations = _check_frame_durations(
-            animation.frames, frame_durations
+            len(animation.frames), frame_durations
         )
         return animation
 
@@ -520,6 +705,6 @@ class Animation(Gadget):
             image.alpha = animation.alpha
             image.parent = animation
         animation.frame_durations = _check_frame_durations(
-            animation.frames, frame_durations
+            len(animation.frames), frame_durations
         )
         return animation
@@ -183,6 +183,8 @@ class BarChart(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
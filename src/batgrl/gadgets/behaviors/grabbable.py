@@ -1,4 +1,6 @@
 """Grabbable behavior for a gadget."""
+from weakref import WeakSet
+
 from ...geometry import Point
 from ...io import MouseButton, MouseEvent, MouseEventType
 
@@ -55,6 +57,9 @@ class Grabbable:
         Update gadget with incoming mouse events while grabbed.
     """
 
+    _grabbed: WeakSet["Grabbable"] = WeakSet()
+    """All grabbed gadgets."""
+
     def __init__(
         self,
         *,
@@ -103,6 +108,19 @@ class Grabbable:
         """True if gadget is grabbed."""
         return self._is_grabbed
 
+    @property
+    def _is_grabbed(self) -> bool:
+        return self in Grabbable._grabbed
+
+    @_is_grabbed.setter
+    def _is_grabbed(self, is_grabbed: bool):
+        # Grabbed gadgets are tracked so that they receive every mouse move when the
+        # root only dispatches mouse moves to gadgets under the mouse.
+        if is_grabbed:
+            Grabbable._grabbed.add(self)
+        else:
+            Grabbable._grabbed.discard(self)
+
     @property
     def mouse_dyx(self) -> Point:
         """Last change in mouse position."""
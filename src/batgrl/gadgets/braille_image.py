@@ -14,7 +14,7 @@ from .gadget import (
     SizeHintDict,
 )
 from .text import Text
-from .text_tools import binary_to_braille
+from .text_tools import rgb_to_braille
 
 __all__ = ["BrailleImage", "Point", "Size"]
 
@@ -127,6 +127,8 @@ class BrailleImage(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -219,35 +221,8 @@ class BrailleImage(Gadget):
         if h == 0 or w == 0:
             return
 
-        canvas = self._image.canvas
         img_bgr = cv2.resize(self._otexture, (2 * w, 4 * h))
         img_rgb = cv2.cvtColor(img_bgr, cv2.COLOR_BGR2RGB)
-        img_hls = cv2.cvtColor(img_bgr, cv2.COLOR_BGR2HLS)
-
-        rgb_sectioned = np.swapaxes(img_rgb.reshape(h, 4, w, 2, 3), 1, 2)
-        hls_sectioned = np.swapaxes(img_hls.reshape(h, 4, w, 2, 3), 1, 2)
-
-        # First, find the average lightness of each 2x2 section of the image
-        # (`average_lightness`). Boxes are placed where the lightness is greater than
-        # `average_lightness`. The background color will be the average of the colors
-        # darker than `average_lightness`. The foreground color will be the average of
-        # the colors lighter than `average_lightness`.
-
-        lightness = hls_sectioned[..., 1]
-        average_lightness = np.average(lightness, axis=(2, 3))
-        where_dots = lightness > average_lightness[..., None, None]
-
-        canvas["char"] = binary_to_braille(where_dots)
-
-        ndots = where_dots.sum(axis=(2, 3))
-        ndots_neg = 8 - ndots
-        ndots[ndots == 0] = 1
-        ndots_neg[ndots_neg == 0] = 1
-
-        foreground = rgb_sectioned.copy()
-        foreground[~where_dots] = 0
-        canvas["fg_color"] = foreground.sum(axis=(2, 3)) / ndots[..., None]
-
-        background = rgb_sectioned.copy()
-        background[where_dots] = 0
-        canvas["bg_color"] = background.sum(axis=(2, 3)) / ndots_neg[..., None]
+        canvas = self._image.canvas
+        canvas["char"], canvas["fg_color"], canvas["bg_color"] = rgb_to_braille(img_rgb)
+        self._image.mark_dirty()
@@ -1,16 +1,16 @@
 """A video gadget that renders to braille unicode characters in grayscale."""
 import asyncio
-import atexit
-import time
 import warnings
 from pathlib import Path
 from platform import uname
 
 import cv2
 import numpy as np
+from numpy.typing import NDArray
 
 from ..colors import BLACK, WHITE, Color
 from ..geometry import lerp
+from ._video_decoder import open_stream
 from .gadget import (
     Gadget,
     Point,
@@ -21,9 +21,9 @@ from .gadget import (
     SizeHintDict,
 )
 from .text import Text
-from .text_tools import binary_to_braille
+from .text_tools import Dither, gray_to_braille
 
-__all__ = ["BrailleVideo", "Point", "Size"]
+__all__ = ["BrailleVideo", "Dither", "Point", "Size"]
 
 _IS_WSL: bool = uname().system == "Linux" and uname().release.endswith("Microsoft")
 
@@ -32,6 +32,9 @@ class BrailleVideo(Gadget):
     r"""
     A video gadget that renders to braille unicode characters in grayscale.
 
+    Frames are decoded and converted to braille in a background thread. Video gadgets
+    with the same source share a decoder, so seeking one seeks all of them.
+
     Parameters
     ----------
     source : pathlib.Path | str | int
@@ -45,6 +48,8 @@ class BrailleVideo(Gadget):
         If true, restart video after last frame.
     gray_threshold : int, default: 127
         Pixel values over this threshold in the source video will be rendered.
+    dither : Dither, default: "none"
+        Dithering method used when converting frames to braille.
     enable_shading : bool, default: False
         Whether foreground colors are shaded.
     invert_colors : bool, default: False
@@ -80,6 +85,8 @@ class BrailleVideo(Gadget):
         If true, video will restart after last frame.
     gray_threshold : int
         Pixel values over this threshold in the source video will be rendered.
+    dither : Dither
+        Dithering method used when converting frames to braille.
     enable_shading : bool
         Whether foreground colors are shaded.
     invert_colors : bool
@@ -171,6 +178,8 @@ class BrailleVideo(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -201,6 +210,7 @@ class BrailleVideo(Gadget):
         bg_color: Color = BLACK,
         loop: bool = True,
         gray_threshold: int = 127,
+        dither: Dither = "none",
         enable_shading: bool = False,
         invert_colors: bool = False,
         alpha: float = 1.0,
@@ -223,7 +233,7 @@ class BrailleVideo(Gadget):
             is_enabled=is_enabled,
         )
         self._current_frame = None
-        self._resource = None
+        self._stream = None
         self._video_task = None
         self.add_gadget(self._video)
         self.source = source
@@ -231,6 +241,7 @@ class BrailleVideo(Gadget):
         self.bg_color = bg_color
         self.loop = loop
         self.gray_threshold = gray_threshold
+        self.dither = dither
         self.enable_shading = enable_shading
         self.invert_colors = invert_colors
         self.alpha = alpha
@@ -283,74 +294,91 @@ class BrailleVideo(Gadget):
         return isinstance(self._source, int)
 
     def _load_resource(self):
-        source = self.source
-
         if _IS_WSL and self.is_device:
             # Because WSL doesn't support most USB devices (yet?), and trying to open
             # one with cv2 will pollute the terminal with cv2 errors, we don't attempt
             # to open a device in this case and instead issue a warning.
             warnings.warn("device not available on WSL")
-            self._resource = None
+            self._stream = None
             return
 
-        if isinstance(source, Path):
-            source = str(source.absolute())
-
-        self._resource = cv2.VideoCapture(source)
-        atexit.register(self._resource.release)
+        self._stream = open_stream(self.source, self._prepare_frame)
 
     def _release_resource(self):
-        if self._resource is not None:
-            self._resource.release()
-            atexit.unregister(self._resource.release)
-            self._resource = None
+        if self._stream is not None:
+            self._stream.close()
+            self._stream = None
             self._current_frame = None
             self._video.clear()
 
-    def _paint_frame(self):
-        h, w = self.size
-        if self._current_frame is None or h == 0 or w == 0:
-            return
+    def _braille_frame(
+        self, gray: NDArray[np.uint8], size: Size
+    ) -> tuple[NDArray[np.str_], NDArray[np.uint8] | None] | None:
+        """
+        Return braille chars and, if shading, colors of a grayscale frame for a gadget
+        of given size.
+        """
+        h, w = size
+        if h == 0 or w == 0:
+            return None
 
-        canvas = self._video.canvas
-        upscaled = cv2.resize(self._current_frame, (2 * w, 4 * h)) > self.gray_threshold
-        sectioned = np.swapaxes(upscaled.reshape(h, 4, w, 2), 1, 2)
-        canvas["char"] = binary_to_braille(sectioned)
+        upscaled = cv2.resize(gray, (2 * w, 4 * h))
+        chars = gray_to_braille(upscaled, self.gray_threshold, self.dither)
 
         if self.enable_shading:
-            normals = cv2.resize(self._current_frame, (w, h)) / 255
+            normals = cv2.resize(gray, (w, h)) / 255
             shades = lerp(self.bg_color, self.fg_color, normals[..., None])
-            canvas["fg_color"] = shades.astype(np.uint8)
-        else:
-            canvas["fg_color"] = self.fg_color
+            return chars, shades.astype(np.uint8)
+        return chars, None
+
+    def _prepare_frame(
+        self, frame: NDArray[np.uint8]
+    ) -> tuple[
+        NDArray[np.uint8], tuple[NDArray[np.str_], NDArray[np.uint8] | None] | None
+    ]:
+        """
+        Prepare a decoded frame for display. Called from the decode thread, so the
+        size is read once; a frame prepared during a resize is redone on display.
+        """
+        gray = cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY)
+        if self.invert_colors:
+            gray = 255 - gray
+        return gray, self._braille_frame(gray, self.size)
 
-    def _time_delta(self) -> float:
-        return time.monotonic() - self._resource.get(cv2.CAP_PROP_POS_MSEC) / 1000
+    def _paint_braille(
+        self, braille: tuple[NDArray[np.str_], NDArray[np.uint8] | None]
+    ):
+        chars, shades = braille
+        canvas = self._video.canvas
+        canvas["char"] = chars
+        canvas["fg_color"] = self.fg_color if shades is None else shades
+        self._video.mark_dirty()
+
+    def _paint_frame(self):
+        if self._current_frame is not None:
+            braille = self._braille_frame(self._current_frame, self.size)
+            if braille is not None:
+                self._paint_braille(braille)
 
     async def _play_video(self):
-        if self._resource is None:
+        if self._stream is None:
             return
 
-        self._start_time = self._time_delta()
-
-        while self._resource.grab():
-            if self.is_device:
-                seconds_ahead = 0
-            elif (seconds_ahead := self._start_time - self._time_delta()) < 0:
-                continue
-
-            try:
-                await asyncio.sleep(seconds_ahead)
-            except asyncio.CancelledError:
-                return
-
-            _, frame = self._resource.retrieve()
-            self._current_frame = cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY)
-            if self.invert_colors:
-                self._current_frame = 255 - self._current_frame
-
-            self._paint_frame()
+        self._stream.play()
+
+        try:
+            while (item := await self._stream.next_frame()) is not None:
+                pts, (gray, braille) = item
+                await asyncio.sleep(max(0, self._stream.seconds_ahead(pts)))
+                self._current_frame = gray
+                if braille is not None and braille[0].shape == self.size:
+                    self._paint_braille(braille)
+                else:  # Resized while frame was prepared.
+                    self._paint_frame()
+        except asyncio.CancelledError:
+            return
 
+        self._stream.pause()
         if self.loop:
             self.seek(0)
             self.play()
@@ -373,6 +401,8 @@ class BrailleVideo(Gadget):
         """Pause video."""
         if self._video_task is not None:
             self._video_task.cancel()
+        if self._stream is not None:
+            self._stream.pause()
 
     def play(self) -> asyncio.Task:
         """
@@ -385,7 +415,7 @@ class BrailleVideo(Gadget):
         """
         self.pause()
 
-        if self._resource is None:
+        if self._stream is None:
             self._load_resource()
 
         self._video_task = asyncio.create_task(self._play_video())
@@ -393,10 +423,8 @@ class BrailleVideo(Gadget):
 
     def seek(self, time: float):
         """If supported, seek to certain time (in seconds) in the video."""
-        if self._resource is not None and not self.is_device:
-            self._resource.set(cv2.CAP_PROP_POS_MSEC, time * 1000)
-            self._resource.grab()
-            self._start_time = self._time_delta()
+        if self._stream is not None and not self.is_device:
+            self._stream.seek(time)
 
     def stop(self):
         """Stop video."""
@@ -244,8 +244,10 @@ class _Prompt(Text):
 class _AlmostPane(Pane):
     def _render(self, canvas):
         console: Console = self.parent.parent
-        self._region -= console._input._region
+        region = self._region
+        self._region = region - console._input._region
         super()._render(canvas)
+        self._region = region
 
 
 class Console(Themable, Focusable, Gadget):
@@ -378,6 +380,8 @@ class Console(Themable, Focusable, Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -1,10 +1,15 @@
-"""A data table gadget."""
-from collections.abc import Callable, Sequence
+"""Data table gadgets."""
+from array import array
+from bisect import bisect_left, bisect_right
+from collections.abc import Callable, Iterator, Sequence
 from dataclasses import dataclass, replace
 from enum import Enum
-from itertools import count, islice
+from itertools import accumulate, count, islice
 from typing import Literal, Protocol, TypeVar
 
+import numpy as np
+from numpy.typing import NDArray
+
 from ..io import MouseEvent
 from .behaviors.button_behavior import ButtonBehavior
 from .behaviors.themable import Themable
@@ -22,7 +27,7 @@ from .pane import Pane
 from .scroll_view import ScrollView
 from .text import Text, add_text, str_width
 
-__all__ = ["DataTable", "ColumnStyle", "Point", "Size"]
+__all__ = ["DataTable", "VirtualDataTable", "ColumnStyle", "Point", "Size"]
 
 
 class SupportsLessThan(Protocol):
@@ -116,6 +121,13 @@ _ALIGN_FORMATTER = {
 """Convert an alignment to f-string format specification."""
 
 
+def _min_cell_size(style: ColumnStyle, data: T) -> Size:
+    """Return the minimum size of a data cell with some data in a column."""
+    lines = style.render(data).split("\n")
+    width = max(str_width(line) for line in lines) + 2 * style.padding
+    return Size(len(lines), max(width, style.min_width))
+
+
 class _CellBase(ButtonBehavior, Text):
     """Base for cells in a data table."""
 
@@ -260,17 +272,10 @@ class _DataCell(_CellBase):
         self.data = data
         """Data of cell."""
 
-        lines = self.style.render(data).split("\n")
-
-        self.cell_min_height = len(lines)
+        min_size = _min_cell_size(self.style, data)
+        self.cell_min_height = min_size.height
         """Minimum allowed height of cell."""
-        self.cell_min_width = max(
-            (
-                max(str_width(line) for line in lines)
-                + 2 * self.style.padding  # width of rendered data
-            ),
-            self.style.min_width,
-        )
+        self.cell_min_width = min_size.width
         """Minimum allowed width of cell."""
         self.row_id = row_id
         """Row id of row cell belongs to."""
@@ -311,8 +316,10 @@ class _DataCell(_CellBase):
 class _FauxPane(Pane):
     def _render(self, canvas):
         data_table: DataTable = self.parent.parent
-        self._region -= data_table._table._region
+        region = self._region
+        self._region = region - data_table._table._region
         super()._render(canvas)
+        self._region = region
 
 
 class DataTable(Themable, Gadget):
@@ -452,6 +459,8 @@ class DataTable(Themable, Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -497,10 +506,8 @@ class DataTable(Themable, Gadget):
             grid_rows=1, grid_columns=0, orientation="lr-tb", is_transparent=True
         )
         """Grid layout containing column label cells."""
-        self._table = GridLayout(
-            grid_rows=1, grid_columns=1, orientation="tb-lr", is_transparent=True
-        )
-        """Grid layout of column label and row grid layouts."""
+        self._table = self._create_table()
+        """Gadget containing column labels and rows."""
 
         self._scroll_view = ScrollView(
             size_hint={"height_hint": 1.0, "width_hint": 1.0}
@@ -547,20 +554,27 @@ class DataTable(Themable, Gadget):
         self._scroll_view.view = self._table
         self.add_gadget(self._scroll_view)
 
-        def update_bars():
-            self._scroll_view.show_horizontal_bar = (
-                self._table.width > self._scroll_view.port_width
-            )
-            self._scroll_view.show_vertical_bar = (
-                self._table.height > self._scroll_view.port_height
-            )
-
-        self._table.bind("size", update_bars)
+        self._table.bind("size", self._update_bars)
 
         if data is not None:
             for label, column_data in data.items():
                 self.add_column(label, data=column_data)
 
+    def _create_table(self) -> Gadget:
+        """Return a grid layout of column label and row grid layouts."""
+        return GridLayout(
+            grid_rows=1, grid_columns=1, orientation="tb-lr", is_transparent=True
+        )
+
+    def _update_bars(self):
+        """Only show scrollbars if table doesn't fit in the port."""
+        self._scroll_view.show_horizontal_bar = (
+            self._table.width > self._scroll_view.port_width
+        )
+        self._scroll_view.show_vertical_bar = (
+            self._table.height > self._scroll_view.port_height
+        )
+
     @property
     def alpha(self) -> float:
         """Transparency of gadget."""
@@ -651,6 +665,7 @@ class DataTable(Themable, Gadget):
         else:
             color_pair = self.color_theme.data_table_hover
         cell.canvas[["fg_color", "bg_color"]] = color_pair
+        cell.mark_dirty()
 
     def _paint_cell_normal(self, cell: _DataCell):
         if cell.selected:
@@ -660,6 +675,7 @@ class DataTable(Themable, Gadget):
         else:
             color_pair = self.color_theme.primary
         cell.canvas[["fg_color", "bg_color"]] = color_pair
+        cell.mark_dirty()
 
     def _repaint_cells(self):
         for row in self._iter_rows():
@@ -765,6 +781,22 @@ class DataTable(Themable, Gadget):
     def _iter_rows(self):
         return islice(self._table.children, 1, None)
 
+    def _add_column_label(self, label: str, style: ColumnStyle) -> int:
+        """Add a column label and style and return the new column's id."""
+        column_id = next(self._IDS)
+        self._column_ids.append(column_id)
+        self._column_styles[column_id] = style
+
+        column_label = _ColumnLabel(
+            data_table=self,
+            column_id=column_id,
+            label=label,
+            allow_sorting=self.allow_sorting and style.allow_sorting,
+        )
+        self._column_labels.grid_columns += 1
+        self._column_labels.add_gadget(column_label)
+        return column_id
+
     def add_column(
         self,
         label: str,
@@ -801,18 +833,7 @@ class DataTable(Themable, Gadget):
         if style is None:
             style = replace(self.default_style)
 
-        column_id = next(self._IDS)
-        self._column_ids.append(column_id)
-        self._column_styles[column_id] = style
-
-        column_label = _ColumnLabel(
-            data_table=self,
-            column_id=column_id,
-            label=label,
-            allow_sorting=self.allow_sorting and style.allow_sorting,
-        )
-        self._column_labels.grid_columns += 1
-        self._column_labels.add_gadget(column_label)
+        column_id = self._add_column_label(label, style)
 
         if len(self._column_ids) == 1:
             self._table.grid_rows += len(data)
@@ -948,3 +969,647 @@ class DataTable(Themable, Gadget):
             Column id of the column at index.
         """
         return self._column_labels.children[index].column_id
+
+
+class _VirtualRow(Gadget):
+    """A recycled row of data cells in a virtual data table."""
+
+    def __init__(self):
+        super().__init__(is_transparent=True)
+        self.index = -1
+        """Index of row shown in the table or -1 if no row is shown."""
+
+
+def _to_array(values: NDArray) -> array:
+    """Convert a 1-dimensional integer array into an `array` of signed 64-bit ints."""
+    return array("q", values.astype(np.int64).tobytes())
+
+
+def _sort_keys(column: list[T]) -> NDArray:
+    """Return column data as an array to sort."""
+    try:
+        keys = np.array(column)
+    except ValueError:  # Inhomogeneous sequences.
+        keys = None
+
+    if keys is None or keys.ndim != 1:
+        keys = np.empty(len(column), dtype=object)
+        keys[:] = column
+    return keys
+
+
+class VirtualDataTable(DataTable):
+    r"""
+    A data table that only creates gadgets for visible rows.
+
+    Table data is stored by column and cells are only created for rows visible in
+    the table's port. As the table scrolls, rows scrolled out of the port are recycled
+    to show the rows scrolled into it. Sorting reorders row indices instead of gadgets.
+    Frame time doesn't depend on the number of rows in the table, so tables of millions
+    of rows remain responsive.
+
+    The API is the same as :class:`DataTable`. Rows are striped and selected by their
+    position in the table.
+
+    Parameters
+    ----------
+    data : dict[str, Sequence[T]] | None=None, default: None
+        If given, construct a data table from this data. To gain more control over
+        column styling use :meth:`add_column`.
+    default_style : ColumnStyle | None, default: None
+        Default style for new columns.
+    select_items : Literal["cell", "row", "column"], default: "row"
+        Determines which items are selected when data table is clicked.
+    zebra_stripes : bool, default: True
+        Whether alternate rows are colored differently.
+    allow_sorting : bool, default: True
+        Whether columns can be sorted.
+    alpha : float, default: 1.0
+        Transparency of gadget.
+    size : Size, default: Size(10, 10)
+        Size of gadget.
+    pos : Point, default: Point(0, 0)
+        Position of upper-left corner in parent.
+    size_hint : SizeHint | SizeHintDict | None, default: None
+        Size as a proportion of parent's height and width.
+    pos_hint : PosHint | PosHintDict | None , default: None
+        Position as a proportion of parent's height and width.
+    is_transparent : bool, default: False
+        Whether gadget is transparent.
+    is_visible : bool, default: True
+        Whether gadget is visible. Gadget will still receive input events if not
+        visible.
+    is_enabled : bool, default: True
+        Whether gadget is enabled. A disabled gadget is not painted and doesn't receive
+        input events.
+
+    Attributes
+    ----------
+    default_style : ColumnStyle
+        Default style for new columns.
+    select_items : Literal["cell", "row", "column"]
+        Which items are selected when data table is clicked.
+    zebra_stripes : bool
+        Whether alternate rows are colored differently.
+    allow_sorting : bool
+        Whether columns can be sorted.
+    alpha : float
+        Transparency of gadget.
+    size : Size
+        Size of gadget.
+    height : int
+        Height of gadget.
+    rows : int
+        Alias for :attr:`height`.
+    width : int
+        Width of gadget.
+    columns : int
+        Alias for :attr:`width`.
+    pos : Point
+        Position of upper-left corner.
+    top : int
+        Y-coordinate of top of gadget.
+    y : int
+        Y-coordinate of top of gadget.
+    left : int
+        X-coordinate of left side of gadget.
+    x : int
+        X-coordinate of left side of gadget.
+    bottom : int
+        Y-coordinate of bottom of gadget.
+    right : int
+        X-coordinate of right side of gadget.
+    center : Point
+        Position of center of gadget.
+    absolute_pos : Point
+        Absolute position on screen.
+    size_hint : SizeHint
+        Size as a proportion of parent's height and width.
+    pos_hint : PosHint
+        Position as a proportion of parent's height and width.
+    parent: Gadget | None
+        Parent gadget.
+    children : list[Gadget]
+        Children gadgets.
+    is_transparent : bool
+        Whether gadget is transparent.
+    is_visible : bool
+        Whether gadget is visible.
+    is_enabled : bool
+        Whether gadget is enabled.
+    root : Gadget | None
+        If gadget is in gadget tree, return the root gadget.
+    app : App
+        The running app.
+
+    Methods
+    -------
+    add_column(label, ...)
+        Add a column to the data table.
+    add_row(data)
+        Add a row to the data table.
+    remove_column(column_id)
+        Remove a column by column id.
+    remove_row(row_id)
+        Remove a row by row id.
+    row_id_from_index(index)
+        Returns the row id of the row at index.
+    column_id_from_index(index)
+        Returns the column id of the column at index.
+    update_theme()
+        Paint the gadget with current theme.
+    on_size()
+        Update gadget after a resize.
+    apply_hints()
+        Apply size and pos hints.
+    to_local(point)
+        Convert point in absolute coordinates to local coordinates.
+    collides_point(point)
+        Return true if point collides with visible portion of gadget.
+    collides_gadget(other)
+        Return true if other is within gadget's bounding box.
+    add_gadget(gadget)
+        Add a child gadget.
+    add_gadgets(\*gadgets)
+        Add multiple child gadgets.
+    remove_gadget(gadget)
+        Remove a child gadget.
+    pull_to_front()
+        Move to end of gadget stack so gadget is drawn last.
+    walk_from_root()
+        Yield all descendents of the root gadget (preorder traversal).
+    walk()
+        Yield all descendents of this gadget (preorder traversal).
+    walk_reverse()
+        Yield all descendents of this gadget (reverse postorder traversal).
+    ancestors()
+        Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
+    bind(prop, callback)
+        Bind `callback` to a gadget property.
+    unbind(uid)
+        Unbind a callback from a gadget property.
+    on_key(key_event)
+        Handle key press event.
+    on_mouse(mouse_event)
+        Handle mouse event.
+    on_paste(paste_event)
+        Handle paste event.
+    tween(...)
+        Sequentially update gadget properties over time.
+    on_add()
+        Apply size hints and call children's `on_add`.
+    on_remove()
+        Call children's `on_remove`.
+    prolicide()
+        Recursively remove all children.
+    destroy()
+        Remove this gadget and recursively remove all its children.
+    """
+
+    def __init__(
+        self,
+        *,
+        data: dict[str, Sequence[T]] | None = None,
+        default_style: ColumnStyle | None = None,
+        select_items: Literal["cell", "row", "column"] = "row",
+        zebra_stripes: bool = True,
+        allow_sorting: bool = True,
+        alpha: float = 1.0,
+        size: Size = Size(10, 10),
+        pos: Point = Point(0, 0),
+        size_hint: SizeHint | SizeHintDict | None = None,
+        pos_hint: PosHint | PosHintDict | None = None,
+        is_transparent: bool = False,
+        is_visible: bool = True,
+        is_enabled: bool = True,
+    ):
+        super().__init__(
+            default_style=default_style,
+            select_items=select_items,
+            zebra_stripes=zebra_stripes,
+            allow_sorting=allow_sorting,
+            alpha=alpha,
+            size=size,
+            pos=pos,
+            size_hint=size_hint,
+            pos_hint=pos_hint,
+            is_transparent=is_transparent,
+            is_visible=is_visible,
+            is_enabled=is_enabled,
+        )
+        self._columns: dict[int, list[T]] = {}
+        """Column id to column data."""
+        self._cell_heights: dict[int, array] = {}
+        """Column id to minimum height of each cell in column."""
+        self._cell_widths: dict[int, array] = {}
+        """Column id to minimum width of each cell in column."""
+        self._column_widths: dict[int, int] = {}
+        """Column id to width of column."""
+        self._column_lefts: list[int] = []
+        """Left of each column."""
+        self._row_ids = array("q")
+        """Row id of each row."""
+        self._row_heights = array("q")
+        """Height of each row."""
+        self._order = array("q")
+        """Row indices in the order they appear in the table."""
+        self._row_tops = array("q")
+        """Top of each row in the order they appear (below column labels)."""
+        self._total_height = 0
+        """Total height of rows."""
+        self._pool: list[_VirtualRow] = []
+        """Rows of cells created for rows in the port."""
+        self._selected: set[int | tuple[int, int]] = set()
+        """Keys of selected items. See :meth:`_item_key`."""
+
+        self._table.bind("pos", self._update_visible_rows)
+        self._scroll_view.bind("size", self._update_visible_rows)
+
+        if data is not None:
+            for label, column_data in data.items():
+                self.add_column(label, data=column_data)
+
+    def _create_table(self) -> Gadget:
+        """Return a gadget the size of all rows that contains recycled rows."""
+        return Gadget(is_transparent=True)
+
+    def _update_bars(self):
+        """Only show scrollbars if table doesn't fit in the port."""
+        super()._update_bars()
+        self._update_visible_rows()
+
+    @DataTable.select_items.setter
+    def select_items(self, select_items: Literal["cell", "row", "column"]):
+        self._select_items = select_items
+        self._selected.clear()
+        self._repaint_cells()
+
+    def update_theme(self):
+        """Paint the gadget with current theme."""
+        super().update_theme()
+        self._repaint_cells()
+
+    def _item_key(self, column_id: int, row_id: int) -> int | tuple[int, int]:
+        """Return key of selectable item that contains a cell."""
+        match self.select_items:
+            case "row":
+                return row_id
+            case "column":
+                return column_id
+            case "cell":
+                return column_id, row_id
+
+    def _visible_cells(self) -> Iterator[_DataCell]:
+        """Yield all cells of rows in the port."""
+        for row in self._pool:
+            if row.index != -1:
+                yield from row.children
+
+    def _paint_cell(self, cell: _DataCell):
+        """Paint cell normal or hovered."""
+        hover_key = self._item_key(self._hover_column_id, self._hover_row_id)
+        if self._item_key(cell.column_id, cell.row_id) == hover_key:
+            self._paint_cell_hover(cell)
+        else:
+            self._paint_cell_normal(cell)
+
+    def _repaint_cells(self):
+        """Repaint all rows in the port."""
+        for row in self._pool:
+            row.index = -1
+        self._update_visible_rows()
+
+    def _update_hover(self, column_id: int = -1, row_id: int = -1):
+        old_key = self._item_key(self._hover_column_id, self._hover_row_id)
+        new_key = self._item_key(column_id, row_id)
+        self._hover_column_id = column_id
+        self._hover_row_id = row_id
+        if old_key == new_key:
+            return
+
+        for cell in self._visible_cells():
+            if self._item_key(cell.column_id, cell.row_id) in (old_key, new_key):
+                self._paint_cell(cell)
+
+    def _on_release(self):
+        key = self._item_key(self._hover_column_id, self._hover_row_id)
+        self._selected ^= {key}
+        for cell in self._visible_cells():
+            if self._item_key(cell.column_id, cell.row_id) == key:
+                cell.selected = key in self._selected
+                self._paint_cell_hover(cell)
+
+    def _new_row(self) -> _VirtualRow:
+        """Add a new row of cells to the pool."""
+        row = _VirtualRow()
+        row.add_gadgets(
+            _DataCell(
+                data_table=self,
+                column_id=column_id,
+                data=self._columns[column_id][0],
+                row_id=-1,
+            )
+            for column_id in self._column_ids
+        )
+        for cell, left in zip(row.children, self._column_lefts):
+            cell.left = left
+        self._table.add_gadget(row)
+        self._pool.append(row)
+        return row
+
+    def _clear_pool(self):
+        """Remove all recycled rows, e.g., if columns change."""
+        for row in self._pool:
+            self._table.remove_gadget(row)
+        self._pool.clear()
+
+    def _show_row(self, row: _VirtualRow, index: int):
+        """Recycle a row of cells to show the row at `index` in the table."""
+        i = self._order[index]
+        row_id = self._row_ids[i]
+        height = self._row_heights[i]
+        striped = self.zebra_stripes and index % 2 == 1
+
+        row.index = index
+        row.is_enabled = True
+        row.pos = self._column_labels.height + self._row_tops[index], 0
+        row.size = height, self._table.width
+
+        cell: _DataCell
+        for cell, column_id in zip(row.children, self._column_ids):
+            cell.data = self._columns[column_id][i]
+            cell.row_id = row_id
+            cell.striped = striped
+            cell.selected = self._item_key(column_id, row_id) in self._selected
+            cell.button_state = "normal"
+            size = Size(height, self._column_widths[column_id])
+            if cell.size == size:
+                cell.on_size()
+            else:
+                cell.size = size
+            self._paint_cell(cell)
+
+    def _update_visible_rows(self):
+        """Show rows in the port, recycling rows scrolled out of the port."""
+        top = -self._table.y - self._column_labels.height
+        bottom = top + self._scroll_view.port_height
+        start = max(bisect_right(self._row_tops, top) - 1, 0)
+        visible = range(start, bisect_left(self._row_tops, bottom))
+
+        shown = {row.index for row in self._pool}
+        free = [row for row in self._pool if row.index not in visible]
+        for index in visible:
+            if index not in shown:
+                self._show_row(free.pop() if free else self._new_row(), index)
+
+        for row in free:
+            row.index = -1
+            row.is_enabled = False
+
+    def _update_row_tops(self):
+        """Recompute tops of rows after rows are reordered or resized."""
+        heights = np.array(self._row_heights)[np.array(self._order)]
+        self._row_tops = _to_array(np.cumsum(heights) - heights)
+        self._total_height = int(heights.sum())
+
+    def _update_column_width(self, column_id: int):
+        """Recompute width of a column from its label and cells."""
+        label = self._column_labels.children[self._column_ids.index(column_id)]
+        self._column_widths[column_id] = max(
+            label.cell_min_width,
+            int(np.max(np.array(self._cell_widths[column_id]), initial=0)),
+        )
+
+    def _fix_sizes(self):
+        labels = self._column_labels
+        label_height = max(
+            (label.cell_min_height for label in labels.children), default=0
+        )
+        widths = [self._column_widths[column_id] for column_id in self._column_ids]
+        for label, width in zip(labels.children, widths):
+            label.size = label_height, width
+        labels.size = labels.minimum_grid_size
+
+        self._column_lefts = list(accumulate(widths[:-1], initial=0))
+        for row in self._pool:
+            row.index = -1
+            for cell, left in zip(row.children, self._column_lefts):
+                cell.left = left
+
+        # Remove hovered rows/columns:
+        self._hover_column_id = self._hover_row_id = -1
+        self._table.size = label_height + self._total_height, sum(widths)
+        self._update_visible_rows()
+
+    def _append_row(self, data: Sequence[T]) -> int:
+        """Store a row at the end of the table and return its row id."""
+        row_id = next(self._IDS)
+        row_height = 0
+        for column_id, item in zip(self._column_ids, data):
+            height, width = _min_cell_size(self._column_styles[column_id], item)
+            self._columns[column_id].append(item)
+            self._cell_heights[column_id].append(height)
+            self._cell_widths[column_id].append(width)
+            if width > self._column_widths[column_id]:
+                self._column_widths[column_id] = width
+            row_height = max(row_height, height)
+
+        self._order.append(len(self._row_ids))
+        self._row_ids.append(row_id)
+        self._row_heights.append(row_height)
+        self._row_tops.append(self._total_height)
+        self._total_height += row_height
+        return row_id
+
+    def _sort(self, column_id: int, sort_state: _SortState):
+        order = np.array(self._order)
+        keys = _sort_keys(self._columns[column_id])[order]
+        if sort_state is _SortState.DESCENDING:
+            # Sort reversed keys so equal keys keep their order, like `sorted` does
+            # with `reverse=True`.
+            indices = len(keys) - 1 - np.argsort(keys[::-1], kind="stable")[::-1]
+        else:
+            indices = np.argsort(keys, kind="stable")
+        self._order = _to_array(order[indices])
+        self._update_row_tops()
+        self._repaint_cells()
+
+    def add_column(
+        self,
+        label: str,
+        data: Sequence[T] | None = None,
+        style: ColumnStyle | None = None,
+    ) -> int:
+        """
+        Add a column to the data table.
+
+        If this is the first column added to the table, a row will be added for each
+        item in `data`. Otherwise, the number of items in data must be equal to the
+        number of rows in the table.
+
+        Parameters
+        ----------
+        label : str
+            The column label.
+        data : Sequence[T] | None, default: None
+            Column data.
+        style : ColumnStyle | None, default: None
+            Column style. Uses :attr:`default_style` by default.
+
+        Returns
+        -------
+        int
+            Column id. This id can be used to remove the column.
+        """
+        if data is None:
+            data = []
+        if self._column_ids and len(data) != len(self._row_ids):
+            raise ValueError(
+                "Number of items in column data inconsistent with number of rows."
+            )
+        if style is None:
+            style = replace(self.default_style)
+
+        column_id = self._add_column_label(label, style)
+        self._columns[column_id] = []
+        self._cell_heights[column_id] = array("q")
+        self._cell_widths[column_id] = array("q")
+        self._update_column_width(column_id)
+
+        if len(self._column_ids) == 1:
+            for item in data:
+                self._append_row([item])
+        else:
+            sizes = [_min_cell_size(style, item) for item in data]
+            heights = np.array([height for height, _ in sizes], dtype=np.int64)
+            self._columns[column_id].extend(data)
+            self._cell_heights[column_id] = _to_array(heights)
+            self._cell_widths[column_id] = array("q", [width for _, width in sizes])
+            self._update_column_width(column_id)
+            self._row_heights = _to_array(
+                np.maximum(np.array(self._row_heights), heights)
+            )
+            self._update_row_tops()
+
+        self._clear_pool()
+        self._fix_sizes()
+        return column_id
+
+    def add_row(self, data: Sequence[SupportsLessThan]) -> int:
+        """
+        Add a row to the data table.
+
+        There must be at least one column before a row can be added. The number
+        of items in the row must match the number of columns.
+
+        Parameters
+        ----------
+        data : Sequence[SupportsLessThan]
+            The row data.
+
+        Returns
+        -------
+        int
+            Row id. This id can be used to remove the row.
+        """
+        if not self._column_ids or len(data) != len(self._column_ids):
+            raise ValueError(
+                "Number of items in row data inconsistent with number of columns."
+            )
+
+        widths = self._column_widths.copy()
+        row_id = self._append_row(data)
+        if self._column_widths != widths:
+            self._fix_sizes()
+        else:
+            self._table.height = self._column_labels.height + self._total_height
+            self._update_visible_rows()
+        return row_id
+
+    def remove_column(self, column_id: int):
+        """
+        Remove a column by column id.
+
+        Column id can be retrieved by index with :meth:`column_id_from_index`.
+
+        Parameters
+        ----------
+        column_id : int
+            The id of the column to remove.
+        """
+        column_index = self._column_ids.index(column_id)
+        del self._column_ids[column_index]
+        self._column_labels.remove_gadget(self._column_labels.children[column_index])
+        self._column_labels.grid_columns -= 1
+        del self._columns[column_id]
+        del self._cell_heights[column_id]
+        del self._cell_widths[column_id]
+        del self._column_widths[column_id]
+        if self.select_items == "column":
+            self._selected.discard(column_id)
+        elif self.select_items == "cell":
+            self._selected = {key for key in self._selected if key[0] != column_id}
+
+        if self._column_ids:
+            heights = [np.array(heights) for heights in self._cell_heights.values()]
+            self._row_heights = _to_array(np.max(heights, axis=0))
+        else:  # Rows without columns are removed.
+            self._row_ids = array("q")
+            self._row_heights = array("q")
+            self._order = array("q")
+            self._selected.clear()
+        self._update_row_tops()
+
+        self._clear_pool()
+        self._fix_sizes()
+
+    def remove_row(self, row_id: int):
+        """
+        Remove a row by row id.
+
+        Row id can be retrieved by index with :meth:`row_id_from_index`.
+
+        Parameters
+        ----------
+        row_id : int
+            The id of the row to remove.
+        """
+        i = self._row_ids.index(row_id)
+        for column_id in self._column_ids:
+            del self._columns[column_id][i]
+            del self._cell_heights[column_id][i]
+            if self._cell_widths[column_id].pop(i) == self._column_widths[column_id]:
+                self._update_column_width(column_id)
+        del self._row_ids[i]
+        del self._row_heights[i]
+
+        order = np.array(self._order)
+        order = order[order != i]
+        order[order > i] -= 1
+        self._order = _to_array(order)
+        self._update_row_tops()
+
+        if self.select_items == "row":
+            self._selected.discard(row_id)
+        elif self.select_items == "cell":
+            self._selected = {key for key in self._selected if key[1] != row_id}
+
+        self._fix_sizes()
+
+    def row_id_from_index(self, index: int) -> int:
+        """
+        Return the row id of the row at index.
+
+        Parameters
+        ----------
+        index : int
+            Index of row in table.
+
+        Returns
+        -------
+        int
+            Row id of the row at index.
+        """
+        return self._row_ids[self._order[index]]
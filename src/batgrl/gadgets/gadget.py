@@ -7,7 +7,6 @@ from itertools import count
 from numbers import Real
 from time import monotonic
 from typing import Coroutine, Literal, Optional, TypedDict
-from weakref import WeakKeyDictionary
 
 import numpy as np
 from numpy.typing import NDArray
@@ -348,17 +347,28 @@ class SizeHintDict(TypedDict, total=False):
 
 
 def bindable(setter):
-    """Decorate property setters to make them bindable."""
-    instances: WeakKeyDictionary[Gadget, Callable[[], None]] = WeakKeyDictionary()
+    """
+    Decorate property setters to make them bindable.
+
+    Bound callbacks are stored on each gadget, so setting a property of a gadget
+    without bindings only checks a single attribute.
+    """
+    name = setter.__name__
 
     @wraps(setter)
     def wrapper(self, *args, **kwargs):
         setter(self, *args, **kwargs)
-        if bindings := instances.get(self):
-            for callback in bindings.values():
-                callback()
+        if self._bound_callbacks is not None and (
+            callbacks := self._bound_callbacks.get(name)
+        ):
+            if (deferred := Gadget._deferred_bindings) is None:
+                for callback in callbacks.values():
+                    callback()
+            else:
+                deferred.update(callbacks)
+        self._request_frame()
 
-    wrapper.instances = instances
+    wrapper.is_bindable = True
 
     return wrapper
 
@@ -463,6 +473,8 @@ class Gadget:
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -487,6 +499,15 @@ class Gadget:
 
     __bindings: dict[int, str] = {}
     """UID to property name mapping."""
+    _bound_callbacks: dict[str, dict[int, Callable[[], None]]] | None = None
+    """Callbacks bound to gadget by uid for each bindable property setter name."""
+    _deferred_bindings: dict[int, Callable[[], None]] | None = None
+    """
+    If set by the tween clock, callbacks of bound properties are collected by uid and
+    called once after all tweens of a frame are advanced.
+    """
+    _mouse_targets: set["Gadget"] | None = None
+    """If set by the root, the only gadgets a mouse event is dispatched to."""
 
     def __init__(
         self,
@@ -526,6 +547,8 @@ class Gadget:
         self.is_visible = is_visible
         self.is_enabled = is_enabled
 
+        self._clip_region: Region = Region()
+        """The portion of the gadget on the screen not clipped by its ancestors."""
         self._region: Region = Region()
         """The visible portion of the gadget on the screen."""
 
@@ -548,17 +571,22 @@ class Gadget:
         size = Size(clamp(int(h), 0, None), clamp(int(w), 0, None))
 
         if self.root:
-            self.root._render_lock.acquire()
+            self.root._lock_geometry()
 
         self._size = size
+        self._invalidate_regions()
         self._apply_pos_hints()
         self.on_size()
 
-        for child in self.children:
-            child.apply_hints()
+        if (root := self.root) is not None and root.batch_layout:
+            # Children's hints are applied once by the root before the next frame.
+            root._layout_pending.add(self)
+        else:
+            for child in self.children:
+                child.apply_hints()
 
         if self.root:
-            self.root._render_lock.release()
+            self.root._unlock_geometry()
 
     @property
     def height(self) -> int:
@@ -592,12 +620,17 @@ class Gadget:
     def pos(self, pos: Point):
         y, x = pos
         pos = Point(int(y), int(x))
+        if pos == self._pos:
+            return
 
         if self.root is None:
             self._pos = pos
         else:
-            with self.root._render_lock:
-                self._pos = pos
+            root = self.root
+            root._lock_geometry()
+            self._pos = pos
+            self._invalidate_regions()
+            root._unlock_geometry()
 
     @property
     def top(self) -> int:
@@ -654,6 +687,36 @@ class Gadget:
         h, w = self.size
         self.pos = Point(cy - h // 2, cx - w // 2)
 
+    @property
+    def is_transparent(self) -> bool:
+        """Whether gadget is transparent."""
+        return self._is_transparent
+
+    @is_transparent.setter
+    def is_transparent(self, is_transparent: bool):
+        self._is_transparent = is_transparent
+        self._invalidate_regions()
+
+    @property
+    def is_visible(self) -> bool:
+        """Whether gadget is visible."""
+        return self._is_visible
+
+    @is_visible.setter
+    def is_visible(self, is_visible: bool):
+        self._is_visible = is_visible
+        self._invalidate_regions()
+
+    @property
+    def is_enabled(self) -> bool:
+        """Whether gadget is enabled."""
+        return self._is_enabled
+
+    @is_enabled.setter
+    def is_enabled(self, is_enabled: bool):
+        self._is_enabled = is_enabled
+        self._invalidate_regions()
+
     @property
     def absolute_pos(self) -> Point:
         """Absolute position on screen."""
@@ -718,12 +781,24 @@ class Gadget:
     def on_size(self):
         """Update gadget after a resize."""
 
+    def _invalidate_regions(self):
+        """
+        Mark gadget's region as stale.
+
+        Regions are only recomputed by the root, starting from the earliest stale gadget
+        in z-order, when some gadget in the tree is marked.
+        """
+        if (root := self.root) is not None:
+            root._stale_regions.add(self)
+            root._request_frame()
+
     def apply_hints(self):
         """
         Apply size and pos hints.
 
         This is called automatically when the gadget is added to the gadget tree and
-        when the gadget's parent's size changes.
+        when the gadget's parent's size changes. If the app batches layout, hints are
+        applied after a parent's size changes once before the next frame instead.
         """
         if self.parent is None:
             return
@@ -866,6 +941,7 @@ class Gadget:
 
         if self.root is not None:
             gadget.on_add()
+            gadget._invalidate_regions()
 
     def add_gadgets(self, *gadgets: "Gadget"):
         r"""
@@ -894,6 +970,7 @@ class Gadget:
         """
         if self.root is not None:
             gadget.on_remove()
+            self._invalidate_regions()
 
         self.children.remove(gadget)
         gadget.parent = None
@@ -903,6 +980,7 @@ class Gadget:
         if self.parent is not None:
             self.parent.children.remove(self)
             self.parent.children.append(self)
+            self._invalidate_regions()
 
     def walk_from_root(self) -> Iterator["Gadget"]:
         """
@@ -954,6 +1032,23 @@ class Gadget:
             yield self.parent
             yield from self.parent.ancestors()
 
+    def mark_dirty(self):
+        """
+        Mark gadget as needing to be repainted.
+
+        If the app is tracking damage, only the visible regions of gadgets marked dirty
+        (and regions whose geometry changed) are repainted each frame. Gadgets that
+        modify their content directly should call this method afterwards.
+        """
+        if (root := self.root) is not None:
+            root._dirty_gadgets.add(self)
+            root._request_frame()
+
+    def _request_frame(self):
+        """Request a frame from the app if gadget is in the gadget tree."""
+        if (root := self.root) is not None and root.app is not None:
+            root.app.request_frame()
+
     def bind(self, prop: str, callback: Callable[[], None]) -> int:
         """
         Bind `callback` to a gadget property. When the property is updated, `callback`
@@ -971,10 +1066,14 @@ class Gadget:
         int
             A unique id used to unbind the callback.
         """
-        uid = next(_UID)
         setter = getattr(type(self), prop).fset
-        bindings = setter.instances.setdefault(self, {})
-        bindings[uid] = callback
+        if not getattr(setter, "is_bindable", False):
+            raise TypeError(f"{prop} is not a bindable property.")
+
+        uid = next(_UID)
+        if self._bound_callbacks is None:
+            self._bound_callbacks = {}
+        self._bound_callbacks.setdefault(setter.__name__, {})[uid] = callback
         self.__bindings[uid] = prop
         return uid
 
@@ -991,8 +1090,10 @@ class Gadget:
         if prop is None:
             return
         setter = getattr(type(self), prop).fset
-        if self in setter.instances:
-            setter.instances[self].pop(uid, None)
+        if self._bound_callbacks is not None and (
+            callbacks := self._bound_callbacks.get(setter.__name__)
+        ):
+            callbacks.pop(uid, None)
 
     def dispatch_key(self, key_event: KeyEvent) -> bool | None:
         """
@@ -1032,10 +1133,11 @@ class Gadget:
         bool | None
             Whether the dispatch was handled.
         """
+        targets = Gadget._mouse_targets
         return any(
             gadget.dispatch_mouse(mouse_event)
             for gadget in reversed(self.children)
-            if gadget.is_enabled
+            if gadget.is_enabled and (targets is None or gadget in targets)
         ) or self.on_mouse(mouse_event)
 
     def dispatch_paste(self, paste_event: PasteEvent) -> bool | None:
@@ -1202,6 +1304,10 @@ class Gadget:
 
         Non-numeric values will be set immediately.
 
+        If gadget is in the gadget tree, all running tweens are advanced together once
+        per frame before layout, and callbacks bound to tweened properties are called
+        once per frame.
+
         Warnings
         --------
         Running several tweens on the same properties concurrently will probably result
@@ -1229,6 +1335,16 @@ class Gadget:
         if on_start is not None:
             on_start()
 
+        if (root := self.root) is not None and duration > 0:
+            # The root's tween clock advances all tweens once per frame.
+            await root._tween_clock.add(
+                self, duration, easing, start_values, properties, on_progress
+            )
+            self._request_frame()
+            if on_complete is not None:
+                on_complete()
+            return
+
         while (current_time := monotonic()) < end_time:
             p = easing_function(1 - (end_time - current_time) / duration)
 
@@ -1238,11 +1354,15 @@ class Gadget:
             if on_progress is not None:
                 on_progress(p)
 
+            self._request_frame()
+
             await asyncio.sleep(0)
 
         for prop, target in properties.items():
             setattr(self, prop, target)
 
+        self._request_frame()
+
         if on_complete is not None:
             on_complete()
 
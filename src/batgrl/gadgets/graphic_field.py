@@ -6,7 +6,6 @@ A particle field specializes in handling many single "pixel" children.
 from typing import Any
 
 import numpy as np
-from numpy.lib.recfunctions import structured_to_unstructured
 from numpy.typing import NDArray
 
 from .gadget import (
@@ -21,6 +20,7 @@ from .gadget import (
     bindable,
     clamp,
 )
+from .text_tools import cell_bytes
 from .texture_tools import _composite
 
 __all__ = ["GraphicParticleField", "particle_data_from_texture", "Point", "Size"]
@@ -150,6 +150,8 @@ class GraphicParticleField(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -234,8 +236,10 @@ class GraphicParticleField(Gadget):
     def _render(self, canvas: NDArray[Cell]):
         """Render visible region of gadget."""
         chars = canvas["char"]
-        styles = canvas[["bold", "italic", "underline", "strikethrough", "overline"]]
-        colors = structured_to_unstructured(canvas[["fg_color", "bg_color"]], np.uint8)
+        styles = cell_bytes(
+            canvas, "bold", "italic", "underline", "strikethrough", "overline"
+        )
+        colors = cell_bytes(canvas, "fg_color", "bg_color")
         offy, offx = self.absolute_pos
         ppos = self.particle_positions
         pcolors = self.particle_colors
@@ -275,7 +279,7 @@ class GraphicParticleField(Gadget):
                 .reshape(height, width, 6)
             )
             chars[dst] = "▀"
-            styles[dst] = False
+            styles[dst] = 0
 
 
 def particle_data_from_texture(
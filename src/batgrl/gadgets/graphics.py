@@ -1,4 +1,5 @@
 """A graphic gadget."""
+from itertools import count
 from pathlib import Path
 
 import cv2
@@ -6,6 +7,7 @@ import numpy as np
 from numpy.typing import NDArray
 
 from ..colors import TRANSPARENT, AColor
+from ..io.output._graphics_protocols import ImagePlacement
 from .gadget import (
     Cell,
     Gadget,
@@ -18,6 +20,7 @@ from .gadget import (
     bindable,
     clamp,
 )
+from .text_tools import cell_bytes
 from .texture_tools import Interpolation, _composite, resize_texture
 
 __all__ = ["Graphics", "Interpolation", "Point", "Size"]
@@ -32,6 +35,10 @@ class Graphics(Gadget):
     :attr:`texture`. Note that the height of :attr:`texture` is twice the height of the
     gadget.
 
+    If the app's :attr:`batgrl.app.App.graphics_protocol` is "kitty" or "sixel",
+    graphic gadgets in the gadget tree are instead sent to the terminal as images of
+    their visible regions and nothing is painted into the canvas for them.
+
     Parameters
     ----------
     default_color : AColor, default: AColor(0, 0, 0, 0)
@@ -120,6 +127,10 @@ class Graphics(Gadget):
         Write :attr:`texture` to provided path as a `png` image.
     clear()
         Fill texture with default color.
+    back_buffer()
+        Return a copy of the latest texture to draw into from any thread.
+    commit(texture)
+        Replace texture at the start of the next frame.
     on_size()
         Update gadget after a resize.
     apply_hints()
@@ -146,6 +157,8 @@ class Graphics(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -168,6 +181,9 @@ class Graphics(Gadget):
         Remove this gadget and recursively remove all its children.
     """
 
+    _image_ids = count(1)
+    """Ids of images for terminal graphics protocols."""
+
     def __init__(
         self,
         *,
@@ -192,6 +208,10 @@ class Graphics(Gadget):
             is_enabled=is_enabled,
         )
 
+        self._image_id = next(Graphics._image_ids)
+        """Id of gadget's image for terminal graphics protocols."""
+        self._as_image = False
+        """Whether gadget is sent to the terminal as an image instead of painted."""
         self.default_color = default_color
         self.interpolation = interpolation
         self.alpha = alpha
@@ -208,6 +228,22 @@ class Graphics(Gadget):
     @bindable
     def alpha(self, alpha: float):
         self._alpha = clamp(float(alpha), 0.0, 1.0)
+        self.mark_dirty()
+
+    @property
+    def texture(self) -> NDArray[np.uint8]:
+        """
+        uint8 RGBA color array.
+
+        Setting the texture marks the gadget dirty. If the texture is modified in-place,
+        :meth:`mark_dirty` should be called afterwards.
+        """
+        return self._texture
+
+    @texture.setter
+    def texture(self, texture: NDArray[np.uint8]):
+        self._texture = texture
+        self.mark_dirty()
 
     def on_size(self):
         """Resize texture array."""
@@ -225,11 +261,29 @@ class Graphics(Gadget):
             raise TypeError(f"{interpolation} is not a valid interpolation type.")
         self._interpolation = interpolation
 
+    def _image_placement(self) -> ImagePlacement:
+        """Return the placement of gadget's texture for terminal graphics protocols."""
+        texture = self._texture.copy()
+        if not self.is_transparent:
+            texture[..., 3] = 255
+        elif self.alpha < 1:
+            texture[..., 3] = texture[..., 3] * self.alpha
+        rects = tuple(
+            (rect.top, rect.bottom, rect.left, rect.right)
+            for rect in self._region.rects()
+        )
+        return ImagePlacement(self._image_id, texture, self.absolute_pos, rects)
+
     def _render(self, canvas: NDArray[Cell]):
         """Render visible region of gadget."""
-        texture = self.texture
+        if self._as_image:
+            return
+
+        texture = self._texture
         chars = canvas["char"]
-        styles = canvas[["bold", "italic", "underline", "strikethrough", "overline"]]
+        styles = cell_bytes(
+            canvas, "bold", "italic", "underline", "strikethrough", "overline"
+        )
         foreground = canvas["fg_color"]
         background = canvas["bg_color"]
         abs_pos = self.absolute_pos
@@ -252,13 +306,61 @@ class Graphics(Gadget):
                 bg_rect[:] = odd_rows[..., :3]
 
             chars[dst] = "▀"
-            styles[dst] = False
+            styles[dst] = 0
 
     def to_png(self, path: Path):
         """Write :attr:`texture` to provided path as a `png` image."""
-        BGRA = cv2.cvtColor(self.texture, cv2.COLOR_RGBA2BGRA)
+        BGRA = cv2.cvtColor(self._texture, cv2.COLOR_RGBA2BGRA)
         cv2.imwrite(str(path.absolute()), BGRA)
 
     def clear(self):
         """Fill texture with default color."""
-        self.texture[:] = self.default_color
+        if self._texture.flags.writeable:
+            self._texture[:] = self.default_color
+            self.mark_dirty()
+        else:  # Texture is shared, e.g., from the texture cache.
+            self.texture = np.full(self._texture.shape, self.default_color, np.uint8)
+
+    def back_buffer(self) -> NDArray[np.uint8]:
+        """
+        Return a copy of the latest texture to draw into from any thread.
+
+        The latest texture is the last texture committed with :meth:`commit` if it
+        hasn't been swapped in yet, else :attr:`texture`.
+
+        Returns
+        -------
+        NDArray[np.uint8]
+            A copy of the latest texture.
+        """
+        if self.root is None:
+            return self._texture.copy()
+        return self.root._latest_buffer(self, self._texture).copy()
+
+    def commit(self, texture: NDArray[np.uint8]):
+        """
+        Replace texture at the start of the next frame.
+
+        Unlike modifying :attr:`texture`, this is safe to call from any thread and
+        never waits for the frame being painted, so numerics can run on other threads
+        while the UI stays responsive. Only the last texture committed before a frame
+        is shown. If the gadget is resized after `texture` was made, it is resized with
+        :attr:`interpolation`.
+
+        Parameters
+        ----------
+        texture : NDArray[np.uint8]
+            The new uint8 RGBA texture, e.g., from :meth:`back_buffer`. The texture
+            shouldn't be modified after it's committed.
+        """
+        if self.root is None:
+            self._swap_buffer(texture)
+        else:
+            self.root._commit(self, texture)
+
+    def _swap_buffer(self, texture: NDArray[np.uint8]):
+        """Swap in a committed texture."""
+        h, w = self.size
+        if texture.shape[:2] != (2 * h, w):
+            texture = resize_texture(texture, (2 * h, w), self.interpolation)
+        self.texture = texture
@@ -15,7 +15,7 @@ from .graphics import (
     SizeHint,
     SizeHintDict,
 )
-from .texture_tools import read_texture, resize_texture
+from .texture_tools import resize_texture, texture_cache
 
 __all__ = ["Image", "Interpolation", "Point", "Size"]
 
@@ -24,6 +24,11 @@ class Image(Graphics):
     r"""
     An Image gadget.
 
+    Images loaded from a path are read and resized through
+    :data:`~batgrl.gadgets.texture_tools.texture_cache`, so their textures are shared
+    with other images of the same path and size until :attr:`texture` is accessed.
+    The image then gets its own copy, so the texture can still be modified in-place.
+
     Parameters
     ----------
     path : pathlib.Path | None, default: None
@@ -144,6 +149,8 @@ class Image(Graphics):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -196,6 +203,23 @@ class Image(Graphics):
         )
         self.path = path
 
+    @property
+    def texture(self) -> NDArray[np.uint8]:
+        """
+        uint8 RGBA color array.
+
+        A texture shared through the texture cache is copied when accessed, so it can
+        be modified in-place. Setting the texture marks the gadget dirty. If the
+        texture is modified in-place, :meth:`mark_dirty` should be called afterwards.
+        """
+        if not self._texture.flags.writeable:
+            self._texture = self._texture.copy()
+        return self._texture
+
+    @texture.setter
+    def texture(self, texture: NDArray[np.uint8]):
+        Graphics.texture.fset(self, texture)
+
     @property
     def path(self) -> Path | None:
         """
@@ -211,13 +235,18 @@ class Image(Graphics):
         if path is None:
             self._otexture = np.full((1, 1, 4), self.default_color, dtype=np.uint8)
         else:
-            self._otexture = read_texture(path)
+            self._otexture = texture_cache.get(path)
         self.on_size()
 
     def on_size(self):
         """Resize texture array."""
         h, w = self._size
-        self.texture = resize_texture(self._otexture, (2 * h, w), self.interpolation)
+        if self._path is None:
+            self.texture = resize_texture(
+                self._otexture, (2 * h, w), self.interpolation
+            )
+        else:
+            self.texture = texture_cache.get(self._path, (2 * h, w), self.interpolation)
 
     @classmethod
     def from_texture(
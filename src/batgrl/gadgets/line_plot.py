@@ -1,14 +1,17 @@
 """A 2D line plot gadget."""
 from collections.abc import Sequence
+from itertools import count
 from math import ceil
 from numbers import Real
 from typing import Literal
 
 import cv2
 import numpy as np
+from numpy.typing import NDArray
 
 from ..colors import DEFAULT_PRIMARY_BG, DEFAULT_PRIMARY_FG, Color, rainbow_gradient
 from ..io import MouseEvent, MouseEventType
+from ._ring_buffer import RingBuffer
 from .behaviors.movable import Movable
 from .gadget import (
     Gadget,
@@ -37,6 +40,59 @@ TICK_HALF = TICK_WIDTH // 2
 VERTICAL_HALF = VERTICAL_SPACING // 2
 
 
+def _decimate(
+    xs: NDArray[np.float64], ys: NDArray[np.float64]
+) -> tuple[NDArray[np.float64], NDArray[np.float64]]:
+    """
+    Decimate a line with sorted x-coordinates in pixel space to the first, minimum,
+    maximum, and last point of each pixel column (M4 decimation).
+
+    A polyline through the decimated points covers the same pixels as one through all
+    points.
+    """
+    columns = np.floor(xs)
+    starts = np.flatnonzero(np.diff(columns, prepend=-np.inf))
+    if 4 * len(starts) >= len(xs):
+        return xs, ys
+
+    ends = np.append(starts[1:], len(xs)) - 1
+    decimated_xs = np.empty((len(starts), 4))
+    decimated_ys = np.empty((len(starts), 4))
+    decimated_xs[:, :3] = xs[starts, None]
+    decimated_xs[:, 3] = xs[ends]
+    decimated_ys[:, 0] = ys[starts]
+    decimated_ys[:, 1] = np.minimum.reduceat(ys, starts)
+    decimated_ys[:, 2] = np.maximum.reduceat(ys, starts)
+    decimated_ys[:, 3] = ys[ends]
+    return decimated_xs.ravel(), decimated_ys.ravel()
+
+
+def _draw_line(
+    bitmap: NDArray[np.uint8],
+    xs: NDArray[np.float64],
+    ys: NDArray[np.float64],
+    bounds: tuple[float, float, float, float],
+    is_sorted: bool,
+) -> int:
+    """
+    Draw a line into a plot bitmap. Return the leftmost pixel column drawn (which may
+    be outside the bitmap).
+    """
+    plot_h, plot_w = bitmap.shape
+    if len(xs) == 0:
+        return plot_w
+
+    min_x, max_x, min_y, max_y = bounds
+    scaled_ys = plot_h * (ys - min_y) / (max_y - min_y)
+    scaled_xs = plot_w * (xs - min_x) / (max_x - min_x)
+    if is_sorted:
+        scaled_xs, scaled_ys = _decimate(scaled_xs, scaled_ys)
+
+    coords = np.dstack((scaled_xs, plot_h - scaled_ys)).astype(int)
+    cv2.polylines(bitmap, coords, isClosed=False, color=1)
+    return int(coords[0, :, 0].min())
+
+
 class _Legend(Movable, Text):
     def _build_legend(self):
         plot: "LinePlot" = self.parent.parent
@@ -111,6 +167,9 @@ class LinePlot(Gadget):
         Optional label for x-axis.
     y_label : str | None, default: None
         Optional label for y-axis.
+    capacity : int | None, default: None
+        Maximum number of points kept for each line by :meth:`append`. If `None`, all
+        points are kept.
     alpha : float, default: 1.0
         Transparency of gadget.
     size : Size, default: Size(10, 10)
@@ -158,6 +217,8 @@ class LinePlot(Gadget):
         Optional label for x-axis.
     y_label : str | None
         Optional label for y-axis.
+    capacity : int | None
+        Maximum number of points kept for each line by :meth:`append`.
     alpha : float
         Transparency of gadget.
     size : Size
@@ -209,6 +270,8 @@ class LinePlot(Gadget):
 
     Methods
     -------
+    append(xs, ys)
+        Append points to the end of each line.
     on_size()
         Update gadget after a resize.
     apply_hints()
@@ -235,6 +298,8 @@ class LinePlot(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -290,6 +355,7 @@ class LinePlot(Gadget):
         plot_bg_color: Color = DEFAULT_PRIMARY_BG,
         x_label: str | None = None,
         y_label: str | None = None,
+        capacity: int | None = None,
         alpha: float = 1.0,
         size: Size = Size(10, 10),
         pos: Point = Point(0, 0),
@@ -344,6 +410,17 @@ class LinePlot(Gadget):
         self.y_label = y_label
         self._traces_zoom_index = 0
         """Index of size hint in `PLOT_ZOOM` that `_traces` is using."""
+        self._buffers: list[tuple[RingBuffer, RingBuffer]] | None = None
+        """Buffers of points of each line for `append`."""
+        self._buffered = None, None
+        """The xs and ys that `_buffers` hold."""
+        self.capacity = capacity
+        self._bitmaps: list[NDArray[np.uint8]] | None = None
+        """Plot of each line from last build, one pixel per braille dot or box."""
+        self._bounds: tuple[float, float, float, float]
+        """min_x, max_x, min_y, and max_y of the bitmaps."""
+        self._sorted: list[bool] | None = None
+        """Whether the xs of each line are sorted."""
 
         def set_x_left():
             self._x_ticks.left = self._traces.left
@@ -370,6 +447,16 @@ class LinePlot(Gadget):
         self.add_gadget(self._container)
         self._legend._build_legend()
 
+    @property
+    def capacity(self) -> int | None:
+        """Maximum number of points kept for each line by :meth:`append`."""
+        return self._capacity
+
+    @capacity.setter
+    def capacity(self, capacity: int | None):
+        self._capacity = capacity
+        self._buffers = None
+
     @property
     def is_transparent(self) -> bool:
         """Whether gadget is transparent."""
@@ -470,7 +557,67 @@ class LinePlot(Gadget):
 
         self._build_plot()
 
+    def append(self, xs: Sequence[Sequence[Real]], ys: Sequence[Sequence[Real]]):
+        """
+        Append points to the end of each line.
+
+        If :attr:`capacity` is set, only the latest `capacity` points of each line are
+        kept. Points are kept in ring buffers, so appending doesn't copy old points.
+
+        If the y-bounds and the width of the x-bounds of the plot don't change, the
+        plot is scrolled by whole cells and only the newly exposed columns are
+        redrawn. Otherwise, the plot is rebuilt.
+
+        Parameters
+        ----------
+        xs : Sequence[Sequence[Real]]
+            x-coordinates of new points of each line.
+        ys : Sequence[Sequence[Real]]
+            y-coordinates of new points of each line.
+        """
+        buffered_xs, buffered_ys = self._buffered
+        if (
+            self._buffers is None
+            or buffered_xs is not self._xs
+            or buffered_ys is not self._ys
+        ):
+            self._buffers = [
+                (RingBuffer(line_xs, self.capacity), RingBuffer(line_ys, self.capacity))
+                for line_xs, line_ys in zip(self._xs, self._ys, strict=True)
+            ]
+
+        appended = []
+        for i, (x_buffer, y_buffer), new_xs, new_ys in zip(
+            count(), self._buffers, xs, ys, strict=True
+        ):
+            new_xs = np.asarray(new_xs, float).ravel()
+            new_ys = np.asarray(new_ys, float).ravel()
+            if len(new_xs) != len(new_ys):
+                raise ValueError("xs and ys of each line must have the same length.")
+            if self._sorted is not None and len(new_xs):
+                last_x = x_buffer.view()[-1:]
+                self._sorted[i] &= bool(
+                    (last_x <= new_xs[0]).all() and (np.diff(new_xs) >= 0).all()
+                )
+            x_buffer.extend(new_xs)
+            y_buffer.extend(new_ys)
+            appended.append(min(len(new_xs), len(x_buffer)))
+
+        self._xs = [x_buffer.view() for x_buffer, _ in self._buffers]
+        self._ys = [y_buffer.view() for _, y_buffer in self._buffers]
+        self._buffered = self._xs, self._ys
+        self._extend_plot(appended)
+
+    def _data_bounds(self) -> tuple[float, float, float, float]:
+        """Return min_x, max_x, min_y, and max_y of plot."""
+        min_x = min(xs.min() for xs in self.xs) if self.min_x is None else self.min_x
+        max_x = max(xs.max() for xs in self.xs) if self.max_x is None else self.max_x
+        min_y = min(ys.min() for ys in self.ys) if self.min_y is None else self.min_y
+        max_y = max(ys.max() for ys in self.ys) if self.max_y is None else self.max_y
+        return min_x, max_x, min_y, max_y
+
     def _build_plot(self):
+        self._bitmaps = None
         h, w = self.size
         if self.root is None or h == 0 or w == 0:
             return
@@ -516,21 +663,7 @@ class LinePlot(Gadget):
         self._traces.canvas["fg_color"] = self.plot_fg_color
         self._traces.canvas["bg_color"] = self.plot_bg_color
 
-        min_x = min(xs.min() for xs in self.xs) if self.min_x is None else self.min_x
-        max_x = max(xs.max() for xs in self.xs) if self.max_x is None else self.max_x
-        min_y = min(ys.min() for ys in self.ys) if self.min_y is None else self.min_y
-        max_y = max(ys.max() for ys in self.ys) if self.max_y is None else self.max_y
-
-        chars_view = self._traces.canvas["char"][:, TICK_HALF:plot_right]
-        colors_view = self._traces.canvas["fg_color"][:, TICK_HALF:plot_right]
-
-        if self.line_colors is None:
-            line_colors = rainbow_gradient(len(self.xs))
-        else:
-            line_colors = self.line_colors
-
-        x_delta = max_x - min_x
-        y_delta = max_y - min_y
+        min_x, max_x, min_y, max_y = bounds = self._data_bounds()
 
         plot_w = offset_w * 2
         if self.mode == "braille":
@@ -538,28 +671,14 @@ class LinePlot(Gadget):
         else:
             plot_h = offset_h * 2
 
-        for xs, ys, color in zip(self.xs, self.ys, line_colors, strict=True):
-            plot = np.zeros((plot_h, plot_w), np.uint8)
-
-            scaled_ys = plot_h * (ys - min_y) / y_delta
-            scaled_xs = plot_w * (xs - min_x) / x_delta
-            coords = np.dstack((scaled_xs, plot_h - scaled_ys)).astype(int)
-
-            cv2.polylines(plot, coords, isClosed=False, color=1)
-
-            if self.mode == "braille":
-                sectioned = np.swapaxes(plot.reshape(offset_h, 4, offset_w, 2), 1, 2)
-                braille = binary_to_braille(sectioned)
-                where_braille = braille != chr(0x2800)  # empty braille character
-
-                chars_view[where_braille] = braille[where_braille]
-                colors_view[where_braille] = color
-            else:
-                sectioned = np.swapaxes(plot.reshape(offset_h, 2, offset_w, 2), 1, 2)
-                boxes = binary_to_box(sectioned)
-                where_boxes = boxes != " "
-                chars_view[where_boxes] = boxes[where_boxes]
-                colors_view[where_boxes] = color
+        self._sorted = [bool((np.diff(xs) >= 0).all()) for xs in self.xs]
+        self._bitmaps = []
+        for xs, ys, is_sorted in zip(self.xs, self.ys, self._sorted, strict=True):
+            bitmap = np.zeros((plot_h, plot_w), np.uint8)
+            _draw_line(bitmap, xs, ys, bounds, is_sorted)
+            self._bitmaps.append(bitmap)
+        self._bounds = bounds
+        self._draw_traces(0, offset_w)
 
         # Regenerate Ticks
         self._y_ticks.size = self._traces.height, TICK_WIDTH
@@ -568,13 +687,6 @@ class LinePlot(Gadget):
         self._y_ticks.canvas["char"][:, :-1] = " "
         self._y_ticks.canvas["char"][1:, -1] = "│"
 
-        self._x_ticks.size = 2, self._traces.width
-        self._x_ticks.canvas["fg_color"] = self.plot_fg_color
-        self._x_ticks.canvas["bg_color"] = self.plot_bg_color
-        self._x_ticks.canvas["char"][0, : plot_right - 1] = "─"
-        self._x_ticks.canvas["char"][0, plot_right:] = " "
-        self._x_ticks.canvas["char"][1:] = " "
-
         self._tick_corner.pos = h - 2 - has_x_label, sv_left - TICK_WIDTH - 1
 
         last_y = offset_h - 1
@@ -586,6 +698,20 @@ class LinePlot(Gadget):
             )
         self._y_ticks.canvas["char"][0, -1] = "┐"
 
+        self._build_x_ticks(min_x, max_x)
+
+    def _build_x_ticks(self, min_x: float, max_x: float):
+        """Regenerate x ticks."""
+        plot_right = self._traces.width - ceil(TICK_WIDTH / 2)
+        offset_w = plot_right - TICK_HALF
+
+        self._x_ticks.size = 2, self._traces.width
+        self._x_ticks.canvas["fg_color"] = self.plot_fg_color
+        self._x_ticks.canvas["bg_color"] = self.plot_bg_color
+        self._x_ticks.canvas["char"][0, : plot_right - 1] = "─"
+        self._x_ticks.canvas["char"][0, plot_right:] = " "
+        self._x_ticks.canvas["char"][1:] = " "
+
         last_x = offset_w - 1
         for column in range(0, offset_w, TICK_WIDTH):
             x_label = lerp(min_x, max_x, column / last_x)
@@ -596,6 +722,101 @@ class LinePlot(Gadget):
             )
         self._x_ticks.canvas["char"][0, plot_right - 1] = "┐"
 
+    def _draw_traces(self, start: int, stop: int):
+        """Draw columns `start` to `stop` of the plot from the bitmaps of each line."""
+        if start >= stop:
+            return
+
+        columns = slice(TICK_HALF + start, TICK_HALF + stop)
+        chars_view = self._traces.canvas["char"][:, columns]
+        colors_view = self._traces.canvas["fg_color"][:, columns]
+        chars_view[:] = " "
+        colors_view[:] = self.plot_fg_color
+
+        if self.line_colors is None:
+            line_colors = rainbow_gradient(len(self.xs))
+        else:
+            line_colors = self.line_colors
+
+        offset_h = self._traces.height
+        offset_w = stop - start
+        for bitmap, color in zip(self._bitmaps, line_colors, strict=True):
+            plot = bitmap[:, 2 * start : 2 * stop]
+            if self.mode == "braille":
+                sectioned = np.swapaxes(plot.reshape(offset_h, 4, offset_w, 2), 1, 2)
+                braille = binary_to_braille(sectioned)
+                where_braille = braille != chr(0x2800)  # empty braille character
+
+                chars_view[where_braille] = braille[where_braille]
+                colors_view[where_braille] = color
+            else:
+                sectioned = np.swapaxes(plot.reshape(offset_h, 2, offset_w, 2), 1, 2)
+                boxes = binary_to_box(sectioned)
+                where_boxes = boxes != " "
+                chars_view[where_boxes] = boxes[where_boxes]
+                colors_view[where_boxes] = color
+
+        self._traces.mark_dirty()
+
+    def _extend_plot(self, appended: list[int]):
+        """
+        Draw points appended to each line, scrolling the plot if the x-bounds moved.
+
+        Falls back to rebuilding the plot if the y-bounds or the width of x-bounds
+        changed, or if the x-coordinates of any line aren't sorted.
+        """
+        if self._bitmaps is None or not all(self._sorted):
+            self._build_plot()
+            return
+
+        old_min_x, old_max_x, old_min_y, old_max_y = self._bounds
+        min_x, max_x, min_y, max_y = self._data_bounds()
+        x_delta = old_max_x - old_min_x
+        plot_h, plot_w = self._bitmaps[0].shape
+        ncolumns = plot_w // 2
+        if (
+            (min_y, max_y) != (old_min_y, old_max_y)
+            or abs(max_x - min_x - x_delta) * plot_w > x_delta
+        ):
+            self._build_plot()
+            return
+
+        # The plot is scrolled by whole cells, so x-bounds are snapped to columns.
+        column_width = 2 * x_delta / plot_w
+        shift = round((min_x - old_min_x) / column_width)
+        if shift < 0 or shift >= ncolumns:
+            self._build_plot()
+            return
+
+        min_x = old_min_x + shift * column_width
+        max_x = min_x + x_delta
+        self._bounds = bounds = min_x, max_x, min_y, max_y
+
+        if shift:
+            traces = self._traces.canvas[:, TICK_HALF : TICK_HALF + ncolumns]
+            traces[:, :-shift] = traces[:, shift:]
+            for bitmap in self._bitmaps:
+                bitmap[:, : -2 * shift] = bitmap[:, 2 * shift :]
+                bitmap[:, -2 * shift :] = 0
+
+        # Redraw from the last point left of the exposed columns (lines clipped at
+        # the old right edge are now exposed) through the new points.
+        start = ncolumns - shift - 1
+        redraw_x = min_x + start * column_width
+        for bitmap, xs, ys, n in zip(
+            self._bitmaps, self.xs, self.ys, appended, strict=True
+        ):
+            if n == 0 and not shift:
+                continue
+            i = min(np.searchsorted(xs, redraw_x, "right") - 1, len(xs) - n - 1)
+            i = max(i, 0)
+            left = _draw_line(bitmap, xs[i:], ys[i:], bounds, True)
+            start = min(start, left // 2)
+
+        self._draw_traces(max(start, 0), ncolumns)
+        if shift:
+            self._build_x_ticks(min_x, max_x)
+
     def on_size(self):
         """Rebuild plot on resize."""
         self._build_plot()
@@ -88,6 +88,7 @@ class _MenuItem(Themable, ToggleButtonBehavior, Pane):
     @is_transparent.setter
     def is_transparent(self, is_transparent: bool):
         self._is_transparent = is_transparent
+        self._invalidate_regions()
         self.left_label.is_transparent = is_transparent
         self.right_label.is_transparent = is_transparent
         if self.submenu is not None:
@@ -329,6 +330,8 @@ class Menu(GridLayout):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -420,6 +423,7 @@ class Menu(GridLayout):
     @is_transparent.setter
     def is_transparent(self, is_transparent: bool):
         self._is_transparent = is_transparent
+        self._invalidate_regions()
         for item in self.children:
             item.is_transparent = is_transparent
 
@@ -859,6 +863,8 @@ class MenuBar(GridLayout):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -971,6 +977,7 @@ class MenuBar(GridLayout):
     @is_transparent.setter
     def is_transparent(self, is_transparent: bool):
         self._is_transparent = is_transparent
+        self._invalidate_regions()
         button: _MenuButton
         for button in self.children:
             button.is_transparent = is_transparent
@@ -14,6 +14,7 @@ from .gadget import (
     bindable,
     clamp,
 )
+from .text_tools import cell_bytes
 from .texture_tools import _composite
 
 __all__ = ["Pane", "Point", "Size"]
@@ -127,6 +128,8 @@ class Pane(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -188,7 +191,9 @@ class Pane(Gadget):
     def _render(self, canvas: NDArray[Cell]):
         """Render visible region of gadget."""
         chars = canvas["char"]
-        styles = canvas[["bold", "italic", "underline", "strikethrough", "overline"]]
+        styles = cell_bytes(
+            canvas, "bold", "italic", "underline", "strikethrough", "overline"
+        )
         foreground = canvas["fg_color"]
         background = canvas["bg_color"]
         for rect in self._region.rects():
@@ -200,5 +205,5 @@ class Pane(Gadget):
                 _composite(bg_rect, self.bg_color, 255, self.alpha)
             else:
                 chars[dst] = " "
-                styles[dst] = False
+                styles[dst] = 0
                 fg_rect[:] = bg_rect[:] = self.bg_color
@@ -168,6 +168,8 @@ class Parallax(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -257,6 +259,7 @@ class Parallax(Gadget):
     @is_transparent.setter
     def is_transparent(self, transparent: bool):
         self._is_transparent = transparent
+        self._invalidate_regions()
         for layer in self.layers:
             layer.is_transparent = True
 
@@ -124,6 +124,150 @@ class RaycasterCamera:
         self._plane = self._plane @ self.rotation_matrix(theta)
 
 
+def _cast_rays(
+    caster_map: NDArray[np.ushort],
+    camera_pos: NDArray[np.float64],
+    ray_angles: NDArray[np.float64],
+    deltas: NDArray[np.float64],
+    steps: NDArray[np.int_],
+    sides: NDArray[np.float64],
+    max_hops: int,
+) -> tuple[NDArray[np.float64], NDArray[np.int_], NDArray[np.ushort], NDArray[np.int_]]:
+    """
+    Cast a ray for every column of the screen.
+
+    Rays are stepped through the map in lockstep (DDA) for at most `max_hops` steps.
+    Rays that hit a wall stop stepping. `sides` is modified in-place.
+
+    This is an internal function used by :class:`Raycaster` and
+    :class:`TextRaycaster`.
+
+    Returns
+    -------
+    tuple[NDArray[np.float64], NDArray[np.int_], NDArray[np.ushort], NDArray[np.int_]]
+        For each ray, the distance from the camera plane to the wall hit (10000 if no
+        wall was hit), the side of the wall hit (0 for north/south, 1 for east/west),
+        the map value of the wall hit (0 if no wall was hit), and the map position of
+        the end of the ray.
+    """
+    nrays = len(ray_angles)
+    rays = np.arange(nrays)
+    ray_pos = np.empty((nrays, 2), int)
+    ray_pos[:] = camera_pos
+    side = np.zeros(nrays, int)
+    texture_index = np.zeros(nrays, caster_map.dtype)
+
+    # Cast rays until they hit a wall or hit max_hops.
+    active = rays
+    for _ in range(max_hops):
+        if len(active) == 0:
+            break
+        active_side = (~(sides[active, 0] < sides[active, 1])).astype(int)
+        sides[active, active_side] += deltas[active, active_side]
+        ray_pos[active, active_side] += steps[active, active_side]
+        side[active] = active_side
+        hit = caster_map[ray_pos[active, 0], ray_pos[active, 1]]
+        texture_index[active] = hit
+        active = active[hit == 0]
+
+    # Distance from wall to camera plane. Note that distance of wall to camera is not
+    # used as it would result in a "fish-eye" effect.
+    with np.errstate(divide="ignore", invalid="ignore"):
+        distance = (
+            ray_pos[rays, side] - camera_pos[side] + (steps[rays, side] != 1)
+        ) / ray_angles[rays, side]
+    distance[texture_index == 0] = 10000  # No walls in range.
+    return distance, side, texture_index, ray_pos
+
+
+def _column_heights(
+    height: int, distance: NDArray[np.float64]
+) -> tuple[NDArray[np.int_], NDArray[np.int_], NDArray[np.int_], NDArray[np.int_]]:
+    """
+    Return the height, half-height (clipped to the screen), and start and end rows of
+    the wall in each column of the screen.
+    """
+    with np.errstate(divide="ignore"):
+        column_height = height / distance
+    column_height[distance == 0] = 10000
+    # Clip heights of walls next to the camera so they fit in an int.
+    column_height = np.minimum(column_height, 2**31).astype(int)
+    half_height = height >> 1
+    half_column = np.minimum(column_height >> 1, half_height)
+    return (
+        column_height,
+        half_column,
+        half_height - half_column,
+        half_height + half_column,
+    )
+
+
+def _wall_texels(
+    columns: NDArray[np.int_],
+    column_height: NDArray[np.int_],
+    start: NDArray[np.int_],
+    end: NDArray[np.int_],
+    tex_x: NDArray[np.int_],
+    tex_h: int,
+) -> tuple[NDArray[np.int_], NDArray[np.int_], NDArray[np.int_], NDArray[np.int_]]:
+    """
+    Return the screen rows and columns of the walls in `columns` and the texture rows
+    and columns sampled by each.
+
+    `column_height`, `start`, `end`, and `tex_x` are given for each of `columns`.
+    """
+    drawn_height = end - start
+    nonempty = drawn_height > 0
+    columns = columns[nonempty]
+    column_height = column_height[nonempty]
+    start = start[nonempty]
+    drawn_height = drawn_height[nonempty]
+    tex_x = tex_x[nonempty]
+
+    # Index of each wall pixel in its column.
+    which = np.repeat(np.arange(len(columns)), drawn_height)
+    firsts = np.cumsum(drawn_height) - drawn_height
+    ys = np.arange(drawn_height.sum()) - firsts[which]
+
+    # Interpolate texture onto columns.
+    offset = (column_height - drawn_height) / 2
+    ratio = tex_h / column_height
+    texture_start = offset * ratio
+    texture_end = (offset + drawn_height) * ratio
+    texture_step = (texture_end - texture_start) / drawn_height
+    tex_ys = (ys * texture_step[which] + texture_start[which]).astype(int)
+
+    return start[which] + ys, columns[which], tex_ys, tex_x[which]
+
+
+def _wall_tex_x(
+    wall_x: NDArray[np.float64],
+    flip: NDArray[np.bool_],
+    tex_w: int,
+) -> NDArray[np.int_]:
+    """Return the column of a texture for where each wall was hit."""
+    tex_x = (wall_x * tex_w).astype(int)
+    return np.where(flip, tex_w - tex_x - 1, tex_x)
+
+
+def _project_sprites(
+    sprites: list[Sprite], camera: RaycasterCamera
+) -> NDArray[np.float64]:
+    """
+    Sort sprites from furthest to closest to camera and return their positions
+    relative to the camera plane.
+    """
+    relative = camera.pos - np.array([sprite.pos for sprite in sprites], float)
+    for sprite, rel in zip(sprites, relative):
+        sprite.relative = rel
+
+    sprites.sort()
+
+    # Camera Inverse used to calculate transformed position of sprites.
+    cam_inv = np.linalg.inv(-camera._plane)
+    return np.array([sprite.relative for sprite in sprites]) @ cam_inv
+
+
 class RgbaTexture(Protocol):
     """
     A RGBA texture. Typically a numpy array.
@@ -304,6 +448,8 @@ class Raycaster(Graphics):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -387,9 +533,7 @@ class Raycaster(Graphics):
         """Determines how far rays are cast."""
 
         # Buffers
-        self._pos_int = np.zeros((2,), dtype=int)
         self._pos_frac = np.zeros((2,), dtype=float)
-        self._floor_pos = np.zeros((2,), dtype=float)
 
         self.on_size()
 
@@ -414,10 +558,6 @@ class Raycaster(Graphics):
         self._deltas = np.zeros_like(angles)
         self._sides = np.zeros_like(angles)
         self._steps = np.zeros_like(angles, dtype=int)
-        self._weights = weights = np.zeros((h, 2), dtype=float)
-        self._tex_frac = np.zeros_like(weights)
-        self._tex_frac_2 = np.zeros_like(weights)
-        self._tex_int = np.zeros_like(weights, dtype=int)
         self._column_distances = np.zeros((w,), dtype=float)
 
     def cast_rays(self):
@@ -442,90 +582,61 @@ class Raycaster(Graphics):
         self.texture[h:, :, :3] = self.floor_color
         self.texture[..., 3] = 255
 
-        for column in range(self.width):
-            self._cast_ray(column)
-
+        self._cast_walls()
         self._cast_sprites()
-
-    def _cast_ray(self, column):
-        """Cast a ray for a given column of the screen."""
-        camera = self.camera
-        camera_pos = camera.pos
-        caster_map = self.caster_map
-
-        ray_pos = self._pos_int
-        ray_pos[:] = camera_pos
-
-        ray_angle = self._rotated_angles[column]
-        delta = self._deltas[column]
-        step = self._steps[column]
-        sides = self._sides[column]
-
-        # Cast a ray until we hit a wall or hit max_hops
-        for _ in range(self.max_hops):
-            side = 0 if sides[0] < sides[1] else 1
-            sides[side] += delta[side]
-            ray_pos[side] += step[side]
-
-            if texture_index := caster_map[tuple(ray_pos)]:
-                # Distance from wall to camera plane.
-                # Note that distance of wall to camera is not used
-                # as it would result in a "fish-eye" effect.
-                distance = (
-                    ray_pos[side] - camera_pos[side] + (0 if step[side] == 1 else 1)
-                ) / ray_angle[side]
-                break
-        else:  # No walls in range.
-            distance = 10000
-
-        self._column_distances[column] = distance
+        self.mark_dirty()
+
+    def _cast_walls(self):
+        """Paint walls, ceiling, and floor of every column."""
+        camera_pos = self.camera.pos
+        ray_angles = self._rotated_angles
+        distance, side, texture_index, ray_pos = _cast_rays(
+            self.caster_map,
+            camera_pos,
+            ray_angles,
+            self._deltas,
+            self._steps,
+            self._sides,
+            self.max_hops,
+        )
+        self._column_distances[:] = distance
 
         texture = self.texture[:, ::-1]
         height = texture.shape[0]
-
-        column_height = int(height / distance) if distance else 10000
-        if column_height == 0:
-            return
-
-        # Start and end y-coordinates of column.
-        half_height = height >> 1
-        half_column = column_height >> 1
-        if half_column > half_height:
-            half_column = half_height
-
-        start = half_height - half_column
-        end = half_height + half_column
-
-        wall_texture = (self.wall_textures if side else self.light_wall_textures)[
-            texture_index - 1
-        ]
-        tex_h, tex_w, _ = wall_texture.shape
+        column_height, half_column, start, end = _column_heights(height, distance)
+        columns = np.arange(len(distance))
+        painted = (texture_index != 0) & (column_height != 0)
 
         # Exactly where wall was hit by ray as a percentage of its width.
-        wall_x = (camera_pos[1 - side] + distance * ray_angle[1 - side]) % 1
-
-        # Use above percentage to grab the column of the texture we need.
-        tex_x = int(wall_x * tex_w)
-        if (-1 if side == 1 else 1) * ray_angle[side] < 0:  # Sign correction.
-            tex_x = tex_w - tex_x - 1
-
-        # Interpolate texture onto column
-        drawn_height = end - start
-        offset = (column_height - drawn_height) / 2
-        ratio = tex_h / column_height
-        texture_start = offset * ratio
-        texture_end = (offset + drawn_height) * ratio
-        tex_ys = np.linspace(
-            texture_start, texture_end, num=drawn_height, endpoint=False, dtype=int
-        )
-        texture_column = wall_texture[tex_ys, tex_x].astype(float)
-
-        # Darken colors further away.
-        texture_column *= np.e ** (-distance * 0.05)
-        np.clip(texture_column, 0, 255, out=texture_column, casting="unsafe")
-
-        # Paint column.
-        texture[start:end, column] = texture_column
+        other_side = 1 - side
+        wall_x = (
+            camera_pos[other_side] + distance * ray_angles[columns, other_side]
+        ) % 1
+        ray_angle = ray_angles[columns, side]
+        flip = np.where(side == 1, -ray_angle, ray_angle) < 0  # Sign correction.
+        darken = np.e ** (-distance * 0.05)  # Darken colors further away.
+
+        # Paint columns of walls that share a texture all at once.
+        keys = 2 * texture_index.astype(int) + side
+        for key in np.unique(keys[painted]).tolist():
+            index, is_dark = divmod(key, 2)
+            wall_texture = (
+                self.wall_textures if is_dark else self.light_wall_textures
+            )[index - 1]
+            tex_h, tex_w, _ = wall_texture.shape
+            wall_columns = columns[painted & (keys == key)]
+            ys, xs, tex_ys, tex_xs = _wall_texels(
+                wall_columns,
+                column_height[wall_columns],
+                start[wall_columns],
+                end[wall_columns],
+                _wall_tex_x(wall_x[wall_columns], flip[wall_columns], tex_w),
+                tex_h,
+            )
+            texels = wall_texture[tex_ys, tex_xs].astype(float)
+            texels *= darken[xs, None]
+            np.clip(texels, 0, 255, out=texels)
+            texture[ys, xs] = texels
 
         # Render floor and ceiling.
         ceiling = self.ceiling
@@ -534,44 +645,32 @@ class Raycaster(Graphics):
         if ceiling is None and floor is None:
             return
 
-        # Buffer views
-        floor_pos = self._floor_pos
-        weights = self._weights[half_column:]
-        tex_frac = self._tex_frac[half_column:]
-        tex_frac_2 = self._tex_frac_2[half_column:]
-        tex_int = self._tex_int[half_column:]
-
         # Floor position
-        if side == 0:
-            facing = float(ray_angle[0] < 0), wall_x
-        else:
-            facing = wall_x, float(ray_angle[1] < 0)
-        np.add(ray_pos, facing, out=floor_pos)
+        facing = np.empty((len(columns), 2))
+        facing[:, 0] = np.where(side == 0, ray_angles[:, 0] < 0, wall_x)
+        facing[:, 1] = np.where(side == 0, wall_x, ray_angles[:, 1] < 0)
+        floor_pos = ray_pos + facing
 
-        # Horizontal distances of floor / ceiling
-        np.divide(self._distances[half_column:], distance, out=weights[:, 0])
-        weights[:, 1] = weights[:, 0]
+        # Horizontal distances of floor / ceiling. Row `r` of these arrays is row
+        # `r` of the bottom half of the screen and row `-r - 1` of the top half.
+        weights = (self._distances[:, None] / distance)[..., None]
 
         # Texture coordinates
-        # (weights * floor_pos + (1 - weights) * camera_pos) % 1
-        np.multiply(weights, floor_pos, out=tex_frac)
-        np.subtract(1.0, weights, out=weights)
-        np.multiply(weights, camera_pos, out=tex_frac_2)
-        np.add(tex_frac, tex_frac_2, out=tex_frac)
-        np.mod(tex_frac, 1.0, out=tex_frac)
+        tex_frac = (weights * floor_pos + (1 - weights) * camera_pos) % 1
+        rs, cs = (
+            (np.arange(height >> 1)[:, None] >= half_column) & painted
+        ).nonzero()
+        tex_frac = tex_frac[rs, cs]
 
         # Paint ceiling
         if ceiling is not None:
-            # Note reversed order of texture coordinates from floor
-            np.multiply(
-                ceiling.shape[:2], tex_frac[::-1], out=tex_int, casting="unsafe"
-            )
-            texture[:start, column] = ceiling[tex_int[:, 0], tex_int[:, 1]]
+            tex_int = (ceiling.shape[:2] * tex_frac).astype(int)
+            texture[(height >> 1) - 1 - rs, cs] = ceiling[tex_int[:, 0], tex_int[:, 1]]
 
         # Paint floor
         if floor is not None:
-            np.multiply(floor.shape[:2], tex_frac, out=tex_int, casting="unsafe")
-            texture[end:, column] = floor[tex_int[:, 0], tex_int[:, 1]]
+            tex_int = (floor.shape[:2] * tex_frac).astype(int)
+            texture[(height >> 1) + rs, cs] = floor[tex_int[:, 0], tex_int[:, 1]]
 
     def _cast_sprites(self):
         """Render all sprites."""
@@ -579,25 +678,16 @@ class Raycaster(Graphics):
         h, w, _ = texture.shape
         half_w = w / 2
 
-        camera = self.camera
-        camera_pos = camera.pos
         sprites = self.sprites
+        if not sprites:
+            return
+
         sprite_textures = self.sprite_textures
         column_distances = self._column_distances
-
-        for sprite in sprites:
-            sprite.relative = camera_pos - sprite.pos
-
-        sprites.sort()
-
-        # Camera Inverse used to calculate transformed position of sprites.
-        cam_inv = np.linalg.inv(-camera._plane)
+        projected = _project_sprites(sprites, self.camera)
 
         # Draw each sprite from furthest to closest.
-        for sprite in sprites:
-            # Transformed position of sprites due to camera position.
-            y, x = sprite.relative @ cam_inv
-
+        for sprite, (y, x) in zip(sprites, projected.tolist()):
             if y <= 0:
                 # Sprite is behind camera, don't draw it.
                 continue
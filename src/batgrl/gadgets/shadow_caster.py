@@ -125,40 +125,48 @@ class LightSource:
 
 
 @dataclass(slots=True)
-class _Interval:
+class _Obstructions:
     """
-    A continuous interval.
-
-    Parameters
-    ----------
-    start : float
-        Start of interval.
-    end : float
-        End of interval.
+    Sorted, disjoint intervals of obstructed angles.
 
     Attributes
     ----------
-    start : float
-        Start of interval.
-    end : float
-        End of interval.
+    starts : list[float]
+        Starts of intervals.
+    ends : list[float]
+        Ends of intervals.
     """
 
-    start: float
-    end: float
-    center: float = field(init=False)
+    starts: list[float] = field(default_factory=list)
+    ends: list[float] = field(default_factory=list)
 
-    def __post_init__(self):
-        self.center = (self.start + self.end) / 2
+    @property
+    def is_full(self) -> bool:
+        """Whether all angles are obstructed."""
+        return len(self.starts) == 1 and self.starts[0] == 0.0 and self.ends[0] == 1.0
 
-    def __contains__(self, item: float) -> bool:
-        return self.start <= item <= self.end
 
-    def __gt__(self, other):
-        if isinstance(other, (float, int)):
-            return other < self.start
+@dataclass(slots=True)
+class _LitArea:
+    """
+    The light of a light source in part of the map.
+
+    Attributes
+    ----------
+    origin : tuple[int, int]
+        Position of light source in caster's coordinates.
+    area : tuple[slice, slice]
+        The part of the map that can be lit by the light source.
+    tiles : NDArray[np.uint32]
+        The map in `area` when the light was cast.
+    intensity : NDArray[np.float64]
+        The strength of light in `area`.
+    """
 
-        return (other.start, other.end) < (self.start, self.end)
+    origin: tuple[int, int]
+    area: tuple[slice, slice]
+    tiles: NDArray[np.uint32]
+    intensity: NDArray[np.float64]
 
 
 class ShadowCaster(Graphics):
@@ -167,6 +175,9 @@ class ShadowCaster(Graphics):
 
     :meth:`cast_shadows` must be called to generate or update :attr:`texture`.
 
+    The light of each light source is cached. A light source is only cast again if it
+    moved or the part of the map within its radius changed.
+
     Parameters
     ----------
     map : NDArray[np.uint32]
@@ -327,6 +338,8 @@ class ShadowCaster(Graphics):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -397,6 +410,21 @@ class ShadowCaster(Graphics):
         self.smoothing = clamp(smoothing, 0.0, 1.0)
         self.not_visible_blocks = not_visible_blocks
 
+        self._submap: NDArray[np.uint32] | None = None
+        """Submap of last cast."""
+        self._resized_map: NDArray[np.uint32] | None = None
+        """Submap of last cast resized to the caster's size."""
+        self._map_rows: list[list[int]] = []
+        """Resized map as lists for fast indexing."""
+        self._total_light: NDArray[np.float64] | None = None
+        """Combined light colors for all light sources."""
+        self._cast_settings: tuple | None = None
+        """Settings cached lights were cast with."""
+        self._lit_areas: dict[int, _LitArea] = {}
+        """Cached light of each light source by id."""
+        self._decays: dict[float, float] = {}
+        """Cached light decay by distance."""
+
     def cast_shadows(self):
         """Update texture by shadow casting all light sources."""
         h, w, _ = self.texture.shape
@@ -409,50 +437,107 @@ class ShadowCaster(Graphics):
         v_scale = h / ch
         h_scale = w / cw
 
-        map = cv2.resize(
-            self.camera.get_submap(self.map),
-            (w, h),
-            interpolation=cv2.INTER_NEAREST,
+        map = self._update_map(h, w)
+
+        settings = (
+            h,
+            w,
+            self.radius,
+            self.smoothing,
+            self.restrictiveness,
+            self.light_decay,
+            self.not_visible_blocks,
         )
+        if settings != self._cast_settings:
+            self._cast_settings = settings
+            self._lit_areas.clear()
+            self._decays.clear()
 
-        # Combined light colors for all light_sources:
-        total_light = np.full((h, w, 3), self.ambient_light, dtype=float)
+        if self._total_light is None or self._total_light.shape[:2] != (h, w):
+            self._total_light = np.empty((h, w, 3), dtype=float)
+        total_light = self._total_light
+        total_light[:] = self.ambient_light
 
+        lit_areas = {}
         for light_source in self.light_sources:
-            colors = np.zeros_like(total_light)
-
             # Calculate light position in camera's coordinates:
             ly, lx = light_source.coords
             origin = round(v_scale * (ly - cy)), round(h_scale * (lx - cx))
 
-            color = light_source.color
+            lit = self._lit_areas.get(id(light_source))
+            if (
+                lit is None
+                or lit.origin != origin
+                or not np.array_equal(lit.tiles, map[lit.area])
+            ):
+                lit = self._cast_light(origin, map)
 
-            for quad in QUADS:
-                self._visible_points_quad(quad, origin, color, colors, map)
+            lit_areas[id(light_source)] = lit
+            total_light[lit.area] += lit.intensity[..., None] * light_source.color
 
-            total_light += colors
+        self._lit_areas = lit_areas
 
         colored_map = self.tile_colors[map]
-        self.texture[..., :3] = colored_map[..., :3] * np.clip(
-            total_light / 255, 0.0, 1.0
-        )
+        np.divide(total_light, 255, out=total_light)
+        np.clip(total_light, 0.0, 1.0, out=total_light)
+        self.texture[..., :3] = colored_map[..., :3] * total_light
         self.texture[..., 3] = colored_map[..., 3]
+        self.mark_dirty()
+
+    def _update_map(self, h: int, w: int) -> NDArray[np.uint32]:
+        """Return the visible portion of the map resized to the caster's size."""
+        submap = self.camera.get_submap(self.map)
+        if (
+            self._resized_map is None
+            or self._resized_map.shape != (h, w)
+            or not np.array_equal(submap, self._submap)
+        ):
+            self._submap = submap
+            self._resized_map = cv2.resize(
+                submap, (w, h), interpolation=cv2.INTER_NEAREST
+            )
+            self._map_rows = self._resized_map.tolist()
+        return self._resized_map
+
+    def _cast_light(self, origin: tuple[int, int], map: NDArray[np.uint32]) -> _LitArea:
+        """Shadow cast a light source at `origin`."""
+        oy, ox = origin
+        h, w = map.shape
+        r = self.radius
+
+        top = clamp(oy - r + 1, 0, h)
+        bottom = clamp(oy + r, top, h)
+        left = clamp(ox - r + 1, 0, w)
+        right = clamp(ox + r, left, w)
+        area = slice(top, bottom), slice(left, right)
 
-    def _visible_points_quad(self, quad, origin, color, colors, map):
+        points = {}
+        for quad in QUADS:
+            self._visible_points_quad(quad, origin, h, w, points)
+
+        intensity = np.zeros((bottom - top, right - left))
+        if points:
+            ys, xs = np.array(list(points)).T
+            intensity[ys - top, xs - left] = list(points.values())
+
+        return _LitArea(origin, area, map[area].copy(), intensity)
+
+    def _visible_points_quad(self, quad, origin, h, w, points):
+        """Add visible points of a quadrant and their light decay to `points`."""
         y, x, vert = quad
         oy, ox = origin
-        h, w, _ = colors.shape
 
+        map_rows = self._map_rows
         light_decay = self.light_decay
+        decays = self._decays
         smooth_radius = self.radius + self.smoothing
+        not_visible_blocks = self.not_visible_blocks
+        is_visible = self._point_is_visible
+        add_obstruction = self._add_obstruction
 
-        obstructions = []
+        obstructions = _Obstructions()
         for i in range(self.radius):
-            if (
-                len(obstructions) == 1
-                and obstructions[0].start == 0.0
-                and obstructions[0].end == 1.0
-            ):
+            if obstructions.is_full:
                 return
 
             theta = 1.0 / float(i + 1)
@@ -467,45 +552,51 @@ class ShadowCaster(Graphics):
                 else:
                     py = oy + j * y
 
-                p = py, px
-
                 if not (0 <= py < h and 0 <= px < w):
                     continue
 
-                if (d := dist(origin, p)) <= smooth_radius:
-                    interval = _Interval(j * theta, (j + 1) * theta)
+                if (d := dist(origin, (py, px))) <= smooth_radius:
+                    start = j * theta
+                    end = (j + 1) * theta
 
-                    if self._point_is_visible(interval, obstructions):
-                        colors[p] = color
-                        colors[p] *= light_decay(d)
+                    if is_visible(start, end, obstructions):
+                        if (decay := decays.get(d)) is None:
+                            decay = decays[d] = light_decay(d)
+                        points[py, px] = decay
 
-                        if map[p] != 0:
-                            self._add_obstruction(obstructions, interval)
+                        if map_rows[py][px] != 0:
+                            add_obstruction(obstructions, start, end)
 
-                    elif self.not_visible_blocks:
-                        self._add_obstruction(obstructions, interval)
+                    elif not_visible_blocks:
+                        add_obstruction(obstructions, start, end)
 
-    def _point_is_visible(self, interval: _Interval, obstructions):
+    def _point_is_visible(
+        self, start: float, end: float, obstructions: _Obstructions
+    ) -> bool:
+        starts = obstructions.starts
+        ends = obstructions.ends
+        center = (start + end) / 2
         start_visible = center_visible = end_visible = True
 
-        a = bisect(obstructions, interval.start)
+        a = bisect(starts, start)
         if a > 0:
             a -= 1
 
-        b = bisect(obstructions, interval.end)
-        if b < len(obstructions):
+        b = bisect(starts, end)
+        if b < len(starts):
             b += 1
 
         for i in range(a, b):
-            obstruction = obstructions[i]
+            obstruction_start = starts[i]
+            obstruction_end = ends[i]
 
-            if start_visible and interval.start in obstruction:
+            if start_visible and obstruction_start <= start <= obstruction_end:
                 start_visible = False
 
-            if center_visible and interval.center in obstruction:
+            if center_visible and obstruction_start <= center <= obstruction_end:
                 center_visible = False
 
-            if end_visible and interval.end in obstruction:
+            if end_visible and obstruction_start <= end <= obstruction_end:
                 end_visible = False
 
         match self.restrictiveness:
@@ -516,27 +607,29 @@ class ShadowCaster(Graphics):
             case "restrictive":
                 return center_visible and start_visible and end_visible
 
-    def _add_obstruction(self, obstructions, obstruction: _Interval):
-        start = obstruction.start
-        end = obstruction.end
+    def _add_obstruction(self, obstructions: _Obstructions, start: float, end: float):
+        starts = obstructions.starts
+        ends = obstructions.ends
 
-        a = bisect(obstructions, start)
-        b = bisect(obstructions, end)
+        a = bisect(starts, start)
+        b = bisect(starts, end)
 
-        if a > 0 and start <= obstructions[a - 1].end:
-            start = obstructions[a - 1].start
+        if a > 0 and start <= ends[a - 1]:
+            start = starts[a - 1]
             a -= 1
 
-        if b < len(obstructions) and obstructions[b].end <= end:
-            end = obstructions[b].end
+        if b < len(starts) and ends[b] <= end:
+            end = ends[b]
             b += 1
-        elif b > 0 and end < obstructions[b - 1].end:
-            end = obstructions[b - 1].end
+        elif b > 0 and end < ends[b - 1]:
+            end = ends[b - 1]
 
         if a == b:
-            obstructions.insert(a, _Interval(start, end))
+            starts.insert(a, start)
+            ends.insert(a, end)
         else:
-            obstructions[a:b] = [_Interval(start, end)]
+            starts[a:b] = [start]
+            ends[a:b] = [end]
 
     def to_map_coords(self, point: Point) -> tuple[float, float]:
         """
@@ -1,5 +1,6 @@
 """A sparkline gadget."""
 from collections.abc import Sequence
+from math import ceil
 from numbers import Real
 
 import numpy as np
@@ -8,6 +9,7 @@ from numpy.typing import NDArray
 from ..colors import DEFAULT_PRIMARY_BG, DEFAULT_PRIMARY_FG, Color, lerp_colors
 from ..io import MouseEvent
 from ._cursor import Cursor
+from ._ring_buffer import RingBuffer
 from .gadget import (
     Gadget,
     Point,
@@ -57,6 +59,10 @@ class Sparkline(Gadget):
         Background color of gadget.
     show_tooltip : bool, default: True
         Whether to show tooltip.
+    capacity : int | None, default: None
+        If given, only the latest `capacity` values of data are kept and each column
+        of the sparkline is a fixed bin of ``ceil(capacity / width)`` values, so that
+        the sparkline scrolls as data is appended.
     tooltip_fg_color : Color, default: DEFAULT_PRIMARY_FG
         Foreground color of tooltip.
     tooltip_bg_color : Color, default: DEFAULT_PRIMARY_BG
@@ -93,6 +99,8 @@ class Sparkline(Gadget):
         Background color of gadget.
     show_tooltip : bool
         Whether to show tooltip.
+    capacity : int | None
+        Maximum number of values of data kept.
     tooltip_fg_color : Color
         Foreground color of tooltip.
     tooltip_bg_color : Color
@@ -146,6 +154,8 @@ class Sparkline(Gadget):
 
     Methods
     -------
+    append(data)
+        Append values to the end of data.
     on_size()
         Update gadget after a resize.
     apply_hints()
@@ -172,6 +182,8 @@ class Sparkline(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -203,6 +215,7 @@ class Sparkline(Gadget):
         highlight_color: Color = DEFAULT_HIGHLIGHT_COLOR,
         bg_color: Color = DEFAULT_PRIMARY_BG,
         show_tooltip: bool = True,
+        capacity: int | None = None,
         tooltip_fg_color: Color = DEFAULT_PRIMARY_FG,
         tooltip_bg_color: Color = DEFAULT_PRIMARY_BG,
         size: Size = Size(10, 10),
@@ -237,6 +250,11 @@ class Sparkline(Gadget):
         self.add_gadget(self._sparkline)
         self._sparkline.add_gadget(self._selector)
 
+        self._proportions: NDArray[np.float64] | None = None
+        """Proportion of height of each column drawn in the sparkline."""
+        self._first_bin = 0
+        """Bin of first column drawn in the sparkline."""
+        self._capacity = capacity
         self.data = data
         self._min_color = min_color
         """Color of minimum value of the sparkline."""
@@ -320,6 +338,7 @@ class Sparkline(Gadget):
     @min_color.setter
     def min_color(self, min_color: Color):
         self._min_color = min_color
+        self._proportions = None
         self._build_sparkline()
 
     @property
@@ -330,16 +349,44 @@ class Sparkline(Gadget):
     @max_color.setter
     def max_color(self, max_color: Color):
         self._max_color = max_color
+        self._proportions = None
         self._build_sparkline()
 
+    @property
+    def capacity(self) -> int | None:
+        """Maximum number of values of data kept."""
+        return self._capacity
+
+    @capacity.setter
+    def capacity(self, capacity: int | None):
+        self._capacity = capacity
+        self._proportions = None
+        self.data = self.data
+
     @property
     def data(self) -> NDArray[np.float64]:
         """Data for the sparkline."""
-        return self._data
+        return self._buffer.view()
 
     @data.setter
     def data(self, data: Sequence[Real] | None):
-        self._data = np.array([]) if data is None else np.array(data, float)
+        self._buffer = RingBuffer([] if data is None else data, self.capacity)
+        self._build_sparkline()
+
+    def append(self, data: Sequence[Real] | Real):
+        """
+        Append values to the end of data.
+
+        Values are kept in a ring buffer, so appending doesn't copy old values. If
+        :attr:`capacity` is set, the sparkline is scrolled and only columns whose bins
+        changed are redrawn.
+
+        Parameters
+        ----------
+        data : Sequence[Real] | Real
+            Values to append.
+        """
+        self._buffer.extend(data)
         self._build_sparkline()
 
     def on_add(self):
@@ -355,8 +402,37 @@ class Sparkline(Gadget):
     def on_size(self):
         """Rebuild sparkline on resize."""
         super().on_size()
+        self._proportions = None
         self._build_sparkline()
 
+    def _bin_walls(self) -> tuple[NDArray[np.int_], int]:
+        """
+        Return boundaries of bins of data and the bin of the first column.
+
+        If :attr:`capacity` is set, bins are aligned to the number of values ever
+        appended, so bins don't change as the oldest values are dropped.
+        """
+        data = self.data
+        if self.capacity is None:
+            if len(data) <= self.width:
+                return np.arange(len(data) + 1), 0
+
+            bin_width = len(data) / self.width
+            walls = np.round(np.arange(self.width + 1) * bin_width).astype(int)
+            return walls, 0
+
+        if len(data) == 0:
+            return np.zeros(1, int), 0
+
+        bin_width = ceil(self.capacity / self.width)
+        ncolumns = ceil(self.capacity / bin_width)
+        total = self._buffer.total
+        start = total - len(data)
+        last_bin = (total - 1) // bin_width
+        first_bin = max(last_bin - ncolumns + 1, start // bin_width)
+        walls = np.arange(first_bin, last_bin + 2) * bin_width
+        return walls.clip(start, total) - start, first_bin
+
     def _build_sparkline(self):
         if not self.root:
             return
@@ -364,40 +440,54 @@ class Sparkline(Gadget):
         self._selector.is_enabled = False
         self._tooltip.is_enabled = False
 
-        if len(self.data) <= self.width:
-            self._walls = np.arange(len(self.data) + 1)
-            self._means = self._mins = self._maxs = self.data
-            bin_proportions = (self.data - self.data.min(initial=0)) / (
-                self.data.max(initial=0) - self.data.min(initial=0)
+        data = self.data
+        self._walls, first_bin = self._bin_walls()
+        if len(self._walls) - 1 == len(data):  # One value per bin.
+            self._means = self._mins = self._maxs = data
+            bin_proportions = (data - data.min(initial=0)) / (
+                data.max(initial=0) - data.min(initial=0)
             )
         else:
-            nbins = self.width
-            self._walls = np.zeros(nbins + 1, int)
-            self._means = np.zeros(nbins)
-            self._mins = np.zeros(nbins)
-            self._maxs = np.zeros(nbins)
-            bin_width = len(self.data) / nbins
-            x = 0
-            for i in range(nbins):
-                start = self._walls[i]
-                stop = round(x + bin_width)
-                x += bin_width
-                self._walls[i + 1] = stop
-                self._mins[i] = self.data[start:stop].min()
-                self._maxs[i] = self.data[start:stop].max()
-                self._means[i] = np.mean(self.data[start:stop])
+            starts = self._walls[:-1]
+            self._mins = np.minimum.reduceat(data, starts)
+            self._maxs = np.maximum.reduceat(data, starts)
+            self._means = np.add.reduceat(data, starts) / np.diff(self._walls)
             bin_proportions = (self._means - self._means.min()) / (
                 self._means.max() - self._means.min()
             )
 
-        self._sparkline.clear()
         chars = self._sparkline.canvas["char"][::-1]
         fg_color = self._sparkline.canvas["fg_color"]
-        for i, bin_proportion in enumerate(bin_proportions):
+
+        # Columns drawn in the last build are scrolled with their bins. Only columns
+        # whose proportions changed are redrawn.
+        old_proportions = self._proportions
+        shift = first_bin - self._first_bin
+        if old_proportions is None or not 0 <= shift < len(old_proportions):
+            self._sparkline.clear()
+            redraw = range(len(bin_proportions))
+        else:
+            if shift:
+                chars[:, :-shift] = chars[:, shift:]
+                fg_color[:, :-shift] = fg_color[:, shift:]
+            old_proportions = old_proportions[shift:]
+            ncolumns = min(len(old_proportions), len(bin_proportions))
+            changed = bin_proportions[:ncolumns] != old_proportions[:ncolumns]
+            chars[:, len(bin_proportions) :] = " "
+            redraw = changed.nonzero()[0].tolist()
+            redraw.extend(range(ncolumns, len(bin_proportions)))
+
+        for i in redraw:
+            bin_proportion = bin_proportions[i]
             smooth_bar = smooth_vertical_bar(self.height, bin_proportion)
+            chars[:, i] = " "
             chars[: len(smooth_bar), i] = smooth_bar
             fg_color[:, i] = lerp_colors(self.min_color, self.max_color, bin_proportion)
 
+        self._proportions = bin_proportions
+        self._first_bin = first_bin
+        self._sparkline.mark_dirty()
+
     def on_mouse(self, mouse_event: MouseEvent) -> bool | None:
         """Show tooltip and highlight column on mouse collision."""
         if not self.collides_point(mouse_event.position):
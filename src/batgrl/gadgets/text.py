@@ -8,6 +8,7 @@ from pygments.lexers import guess_lexer
 from pygments.style import Style
 
 from ..colors import Color, Neptune
+from ._syntax_highlighter import SyntaxHighlighter
 from .gadget import (
     Cell,
     Gadget,
@@ -27,6 +28,7 @@ from .text_tools import (
     _text_to_cells,
     _write_lines_to_canvas,
     add_text,
+    cell_bytes,
     cell_sans,
     char_width,
     str_width,
@@ -187,6 +189,10 @@ class Text(Gadget):
         Fill canvas with default cell.
     shift(n=1)
         Shift content in canvas up (or down in case of negative `n`).
+    back_buffer()
+        Return a copy of the latest canvas to write into from any thread.
+    commit(canvas)
+        Replace canvas at the start of the next frame.
     on_size()
         Update gadget after a resize.
     apply_hints()
@@ -213,6 +219,8 @@ class Text(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -261,6 +269,8 @@ class Text(Gadget):
         self.default_cell = default_cell
         self.canvas = np.full(size, self.default_cell)
         self.alpha = alpha
+        self._highlighter: SyntaxHighlighter | None = None
+        """Highlighter of last call to `add_syntax_highlighting`."""
 
     @property
     def default_cell(self) -> NDArray[Cell]:
@@ -298,6 +308,7 @@ class Text(Gadget):
     @bindable
     def alpha(self, alpha: float):
         self._alpha = clamp(float(alpha), 0.0, 1.0)
+        self.mark_dirty()
 
     def on_size(self):
         """Resize canvas preserving as much content as possible."""
@@ -355,12 +366,18 @@ class Text(Gadget):
             self.canvas["bg_color"][[0, -1]] = bg_color
             self.canvas["bg_color"][:, [0, -1]] = bg_color
 
+        self.mark_dirty()
+
     def add_syntax_highlighting(
         self, lexer: Lexer | None = None, style: Style = Neptune
     ):
         """
         Add syntax highlighting to current text in canvas.
 
+        Lexer state is cached per line, so highlighting again after the text changes
+        only re-lexes changed lines. If no lexer is given and text was highlighted
+        before, the previous lexer is reused.
+
         Parameters
         ----------
         lexer : pygments.lexer.Lexer | None, default: None
@@ -368,37 +385,23 @@ class Text(Gadget):
         style : pygments.style.Style, default: Neptune
             A pygments style to use for syntax highlighting.
         """
-        text = "\n".join("".join(line).rstrip() for line in self.canvas["char"])
-        if lexer is None:
-            lexer = guess_lexer(text)
+        lines = ["".join(line).rstrip() for line in self.canvas["char"]]
+        highlighter = self._highlighter
+        if (
+            highlighter is None
+            or highlighter.style is not style
+            or (lexer is not None and lexer is not highlighter.lexer)
+        ):
+            if lexer is None:
+                lexer = guess_lexer("\n".join(lines))
+            highlighter = self._highlighter = SyntaxHighlighter(lexer, style, lines)
+        else:
+            highlighter.set_lines(lines)
 
         self.canvas["fg_color"] = 0
         self.canvas["bg_color"] = Color.from_hex(style.background_color)
-        y = x = 0
-        for ttype, value in lexer.get_tokens(text):
-            lines = value.split("\n")
-            token_style = style.style_for_token(ttype)
-            for i, line in enumerate(lines):
-                if i > 0:
-                    y += 1
-                    x = 0
-
-                if len(line) == 0:
-                    continue
-
-                end = x + str_width(line)
-                if token_style["color"]:
-                    self.canvas[y, x:end]["fg_color"] = Color.from_hex(
-                        token_style["color"]
-                    )
-                if token_style["bgcolor"]:
-                    self.canvas[y, x:end]["bg_color"] = Color.from_hex(
-                        token_style["bgcolor"]
-                    )
-                self.canvas[y, x:end]["bold"] = token_style["bold"]
-                self.canvas[y, x:end]["italic"] = token_style["italic"]
-                self.canvas[y, x:end]["underline"] = token_style["underline"]
-                x = end
+        highlighter.paint(self.canvas)
+        self.mark_dirty()
 
     def add_str(
         self,
@@ -449,6 +452,7 @@ class Text(Gadget):
             markdown=markdown,
             truncate_text=truncate_str,
         )
+        self.mark_dirty()
 
     def set_text(
         self,
@@ -484,12 +488,13 @@ class Text(Gadget):
         text_tools.add_text : Add multiple lines of text to a view of a canvas.
         """
         self.size, lines = _parse_batgrl_md(text) if markdown else _text_to_cells(text)
-        self.clear()
+        self.clear()  # Marks gadget dirty.
         _write_lines_to_canvas(lines, self.canvas, fg_color, bg_color)
 
     def clear(self):
         """Fill canvas with default cell."""
         self.canvas[:] = self.default_cell
+        self.mark_dirty()
 
     def shift(self, n: int = 1):
         """
@@ -503,14 +508,65 @@ class Text(Gadget):
         elif n < 0:
             self.canvas[-n:] = self.canvas[:n]
             self.canvas[:-n] = self.default_cell
+        self.mark_dirty()
+
+    def back_buffer(self) -> NDArray[Cell]:
+        """
+        Return a copy of the latest canvas to write into from any thread.
+
+        The latest canvas is the last canvas committed with :meth:`commit` if it
+        hasn't been swapped in yet, else :attr:`canvas`. Text can be added to the copy
+        with :func:`batgrl.gadgets.text_tools.add_text`.
+
+        Returns
+        -------
+        NDArray[Cell]
+            A copy of the latest canvas.
+        """
+        if self.root is None:
+            return self.canvas.copy()
+        return self.root._latest_buffer(self, self.canvas).copy()
+
+    def commit(self, canvas: NDArray[Cell]):
+        """
+        Replace canvas at the start of the next frame.
+
+        Unlike modifying :attr:`canvas`, this is safe to call from any thread and
+        never waits for the frame being painted. Only the last canvas committed before
+        a frame is shown. If the gadget is resized after `canvas` was made, as much of
+        `canvas` as fits is kept.
+
+        Parameters
+        ----------
+        canvas : NDArray[Cell]
+            The new canvas, e.g., from :meth:`back_buffer`. The canvas shouldn't be
+            modified after it's committed.
+        """
+        if self.root is None:
+            self._swap_buffer(canvas)
+        else:
+            self.root._commit(self, canvas)
+
+    def _swap_buffer(self, canvas: NDArray[Cell]):
+        """Swap in a committed canvas."""
+        if canvas.shape != self._size:
+            h, w = self._size
+            old_h, old_w = canvas.shape
+            copy_h = min(old_h, h)
+            copy_w = min(old_w, w)
+            resized = np.full((h, w), self.default_cell)
+            resized[:copy_h, :copy_w] = canvas[:copy_h, :copy_w]
+            canvas = resized
+        self.canvas = canvas
+        self.mark_dirty()
 
     def _render(self, canvas: NDArray[Cell]):
         """Render visible region of gadget."""
-        sans_bg = canvas[cell_sans("bg_color")]
+        sans_bg = cell_bytes(canvas, *cell_sans("bg_color"))
         foreground = canvas["fg_color"]
         background = canvas["bg_color"]
         text_chars = self.canvas["char"]
-        text_sans_bg = self.canvas[cell_sans("bg_color")]
+        text_sans_bg = cell_bytes(self.canvas, *cell_sans("bg_color"))
         text_bg = self.canvas["bg_color"]
         abs_pos = self.absolute_pos
         alpha = self.alpha
@@ -1,62 +1,63 @@
-from collections.abc import Iterator
-from dataclasses import dataclass
+"""Helpers for building batched particle paths and colors."""
+import numpy as np
+from numpy.typing import NDArray
 
-from ..text_field import Point, TextParticleField
-from ..text_tools import Cell
+from ...colors import Color
 
+RNG = np.random.default_rng()
 
-@dataclass
-class Particle:
+
+def line_paths(*points: NDArray[np.float64]) -> NDArray[np.float64]:
     """
-    A wrapper around an index into a text particle field's particle arrays.
+    Return paths of line segments through points.
 
     Parameters
     ----------
-    field : TextParticleField
-        The field which the particle belongs.
-    index : int
-        The index of the particle in the field.
+    *points : NDArray[np.float64]
+        Points or arrays of points with shape `(N, 2)` visited by each path in order.
 
-    Attributes
-    ----------
-    field : TextParticleField
-        The field which the particle belongs.
-    index : int
-        The index of the particle in the field.
-    cell : Cell
-        The particle's cell.
-    pos : Point
-        The particle's position.
-
-    Methods
+    Returns
     -------
-    iter_from_field(field)
-        Yield all particles from a text particle field.
+    NDArray[np.float64]
+        Control points of paths with shape `(N, len(points) - 1, 2, 2)`.
+    """
+    points = np.stack(np.broadcast_arrays(*map(np.asarray, points)), axis=1)
+    points = points.astype(float)
+    return np.stack([points[:, :-1], points[:, 1:]], axis=2)
+
+
+def quadratic_paths(*points: NDArray[np.float64]) -> NDArray[np.float64]:
     """
+    Return paths of quadratic Bezier curves through control points.
 
-    field: TextParticleField
-    index: int
+    Consecutive curves share an end point, so the curves of each path have control
+    points ``points[0:3]``, ``points[2:5]``, and so on.
 
-    @property
-    def cell(self) -> Cell:
-        """The particle's cell."""
-        return self.field.particle_cells[self.index]
+    Parameters
+    ----------
+    *points : NDArray[np.float64]
+        An odd number (at least 3) of points or arrays of points with shape `(N, 2)`.
+
+    Returns
+    -------
+    NDArray[np.float64]
+        Control points of paths with shape `(N, (len(points) - 1) // 2, 3, 2)`.
+    """
+    points = np.stack(np.broadcast_arrays(*map(np.asarray, points)), axis=1)
+    points = points.astype(float)
+    return np.stack([points[:, :-2:2], points[:, 1:-1:2], points[:, 2::2]], axis=2)
 
-    @cell.setter
-    def cell(self, cell: Cell):
-        self.field.particle_cells[self.index] = cell
 
-    @property
-    def pos(self) -> Point:
-        """The particle's position."""
-        return Point(*self.field.particle_positions[self.index].tolist())
+def random_colors(colors: list[Color], n: int) -> NDArray[np.uint8]:
+    """Return `n` colors chosen randomly from `colors`."""
+    return np.array(colors, np.uint8)[RNG.integers(len(colors), size=n)]
 
-    @pos.setter
-    def pos(self, pos: Point):
-        self.field.particle_positions[self.index] = pos
 
-    @classmethod
-    def iter_from_field(cls, field: TextParticleField) -> Iterator["Particle"]:
-        """Yield all particles from a text particle field."""
-        for i in range(len(field.particle_positions)):
-            yield cls(field, i)
+def random_nearby_points(
+    points: NDArray[np.float64], n: int, max_distance: float = 7.0
+) -> NDArray[np.float64]:
+    """Return `n` random points within `max_distance` of each point."""
+    distances = RNG.random((n, len(points), 1)) * max_distance
+    angles = RNG.random((n, len(points))) * 2 * np.pi
+    offsets = np.stack([np.sin(angles), np.cos(angles)], axis=-1)
+    return points + distances * offsets
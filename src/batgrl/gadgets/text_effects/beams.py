@@ -1,14 +1,14 @@
 """A beam effect."""
 import asyncio
-from collections.abc import Callable
-from random import random, shuffle
-from typing import Coroutine, Literal
+from time import monotonic
 
 import numpy as np
-from numpy.typing import NDArray
 
 from ...colors import WHITE, Color, gradient
 from ..text import Text
+from ..text_field import TextParticleField
+from ..text_tools import cell
+from ._particle import RNG
 
 HORIZONTAL_BEAM = "▁▁▁▁▁▁▁▁▂▂▂▂▂▂▂▂▃▃▃▃▃▃▃▃▄▄▄▄▄▄▄▄"
 VERTICAL_BEAM = "▏\n▏\n▏\n▏\n▎\n▎\n▎\n▎\n▍\n▍\n▍\n▍\n▌\n▌\n▌\n▌"
@@ -31,145 +31,91 @@ async def beams_effect(text: Text):
     --------
     Modifying `text` size while effect is running will break the effect.
     """
+    h, w = text.size
     cover = Text(size=text.size)
     cover.canvas[:] = text.canvas
     cover.canvas["fg_color"] = cover.canvas["bg_color"]
 
-    pass_count = np.zeros(text.size, int)
-    beams, tweens = _create_beams(pass_count, cover)
-    shuffle(tweens)
+    # Each beam is a group of particles: 32 for each row and 16 for each column.
+    hchars = np.array(list(HORIZONTAL_BEAM))
+    vchars = np.array(VERTICAL_BEAM.split("\n"))
+    hgrad = np.array(HORIZONTAL_GRAD, np.uint8)
+    vgrad = np.array(VERTICAL_GRAD, np.uint8)
+    hlen = len(hchars)
+    vlen = len(vchars)
+
+    rightward = RNG.random(h) < 0.5
+    downward = RNG.random(w) < 0.5
+    row_starts = np.where(rightward, -hlen - 1, w)
+    row_ends = np.where(rightward, w, -hlen - 1)
+    col_starts = np.where(downward, -vlen - 1, h)
+    col_ends = np.where(downward, h, -vlen - 1)
+
+    cells = np.full(h * hlen + w * vlen, cell())
+    cells["char"] = np.concatenate(
+        [
+            np.where(rightward[:, None], hchars, hchars[::-1]).ravel(),
+            np.where(downward[:, None], vchars, vchars[::-1]).ravel(),
+        ]
+    )
+    cells["fg_color"] = np.concatenate(
+        [
+            np.where(rightward[:, None, None], hgrad, hgrad[::-1]).reshape(-1, 3),
+            np.where(downward[:, None, None], vgrad, vgrad[::-1]).reshape(-1, 3),
+        ]
+    )
+    field = TextParticleField(
+        particle_positions=np.zeros((len(cells), 2), int),
+        particle_cells=cells,
+        size_hint={"height_hint": 1.0, "width_hint": 1.0},
+        is_transparent=True,
+    )
+    positions = field.particle_positions
+    row_positions = positions[: h * hlen].reshape(h, hlen, 2)
+    col_positions = positions[h * hlen :].reshape(w, vlen, 2)
+    row_positions[..., 0] = np.arange(h)[:, None]
+    col_positions[..., 1] = np.arange(w)[:, None]
+
+    # Beams start in a random order, each a random fraction of 0.1s after the last.
+    nbeams = h + w
+    durations = 0.3 + RNG.random(nbeams)
+    gaps = 0.1 * RNG.random(nbeams)
+    gaps[0] = 0
+    delays = np.empty(nbeams)
+    delays[RNG.permutation(nbeams)] = gaps.cumsum()
 
-    cover.add_gadgets(beams)
-    text.add_gadget(cover)
-
-    tasks = [asyncio.create_task(_fade_cover(pass_count, cover, text))]
-    for tween in tweens:
-        tasks.append(asyncio.create_task(tween))
-        await asyncio.sleep(0.1 * random())
-
-    await asyncio.gather(*tasks)
+    cover_fg = cover.canvas["fg_color"]
+    text_fg = text.canvas["fg_color"].astype(float)
+    passed = np.zeros((h, w), bool)
+    xs = np.arange(w)
+    ys = np.arange(h)
 
-    text.remove_gadget(cover)
+    cover.add_gadget(field)
+    text.add_gadget(cover)
 
+    start_time = monotonic()
+    while True:
+        p = ((monotonic() - start_time - delays) / durations).clip(0, 1)
+        lefts = row_starts + (row_ends - row_starts) * p[:h]
+        tops = col_starts + (col_ends - col_starts) * p[h:]
+        lefts = np.floor(lefts).astype(int)[:, None]
+        tops = np.floor(tops).astype(int)[:, None]
+        row_positions[..., 1] = lefts + np.arange(hlen)
+        col_positions[..., 0] = tops + np.arange(vlen)
+
+        rows_passed = np.where(rightward[:, None], xs <= lefts + hlen, xs >= lefts)
+        cols_passed = np.where(downward[:, None], ys <= tops + vlen, ys >= tops)
+        now_passed = rows_passed | cols_passed.T
+        cover_fg[now_passed & ~passed] = WHITE
+        passed = now_passed
 
-def _create_on_progress(
-    pass_count: NDArray[np.int32],
-    cover: Text,
-    beam: Text,
-    kind: Literal["down", "left", "right", "up"],
-) -> Callable[[], None]:
-    if kind == "down":
-        last_bottom = beam.bottom
-
-        def on_progress(*args):
-            nonlocal last_bottom
-            if beam.bottom != last_bottom:
-                pass_count[last_bottom + 1 : beam.bottom + 1, beam.x] += 1
-                cover.canvas[last_bottom + 1 : beam.bottom + 1, beam.x][
-                    "fg_color"
-                ] = WHITE
-                last_bottom = beam.bottom
-
-    elif kind == "left":
-        last_left = beam.left
-
-        def on_progress(*args):
-            nonlocal last_left
-            if beam.left != last_left:
-                left = max(beam.left, 0)
-                pass_count[beam.y, left:last_left] += 1
-                cover.canvas[beam.y, left:last_left]["fg_color"] = WHITE
-                last_left = beam.left
-
-    elif kind == "right":
-        last_right = beam.right
-
-        def on_progress(*args):
-            nonlocal last_right
-            if beam.right != last_right:
-                pass_count[beam.y, last_right + 1 : beam.right + 1] += 1
-                cover.canvas[beam.y, last_right + 1 : beam.right + 1][
-                    "fg_color"
-                ] = WHITE
-                last_right = beam.right
-
-    else:
-        last_top = beam.top
-
-        def on_progress(*args):
-            nonlocal last_top
-            if beam.top != last_top:
-                top = max(beam.top, 0)
-                pass_count[top:last_top, beam.x] += 1
-                cover.canvas[top:last_top, beam.x]["fg_color"] = WHITE
-                last_top = beam.top
-
-    return on_progress
-
-
-def _create_beams(
-    pass_count: NDArray[np.int32], cover: Text
-) -> tuple[list[Text], list[Coroutine]]:
-    h, w = cover.size
-    beams = []
-    tweens = []
-    for y in range(h):
-        beam = Text(is_transparent=True)
-        beam.y = y
-        duration = 0.3 + random()
-        if round(random()):
-            beam.set_text(HORIZONTAL_BEAM)
-            beam.canvas["fg_color"] = HORIZONTAL_GRAD
-            beam.right = -1
-            tween = beam.tween(
-                duration=duration,
-                on_progress=_create_on_progress(pass_count, cover, beam, "right"),
-                left=w,
-            )
-        else:
-            beam.set_text(HORIZONTAL_BEAM[::-1])
-            beam.canvas["fg_color"] = HORIZONTAL_GRAD[::-1]
-            beam.left = w
-            tween = beam.tween(
-                duration=duration,
-                on_progress=_create_on_progress(pass_count, cover, beam, "left"),
-                right=-1,
-            )
-        beams.append(beam)
-        tweens.append(tween)
-
-    for x in range(w):
-        beam = Text(is_transparent=True)
-        beam.x = x
-        duration = 0.3 + random()
-        if round(random()):
-            beam.set_text(VERTICAL_BEAM)
-            beam.canvas["fg_color"][:, 0] = VERTICAL_GRAD
-            beam.bottom = -1
-            tween = beam.tween(
-                duration=duration,
-                on_progress=_create_on_progress(pass_count, cover, beam, "down"),
-                top=h,
-            )
-        else:
-            beam.set_text(VERTICAL_BEAM[::-1])
-            beam.canvas["fg_color"][:, 0] = VERTICAL_GRAD[::-1]
-            beam.top = h
-            tween = beam.tween(
-                duration=duration,
-                on_progress=_create_on_progress(pass_count, cover, beam, "up"),
-                bottom=-1,
-            )
-        beams.append(beam)
-        tweens.append(tween)
-    return beams, tweens
-
-
-async def _fade_cover(pass_count: NDArray[np.int32], cover: Text, text: Text):
-    cover_fg = cover.canvas["fg_color"]
-    text_fg = text.canvas["fg_color"].astype(float)
-    while not np.array_equal(cover_fg, text_fg):
-        passed_mask = pass_count >= 1
         faded = cover_fg * 0.99 + text_fg * 0.01
-        cover_fg[passed_mask] = faded.astype(np.uint8)[passed_mask]
+        cover_fg[passed] = faded.astype(np.uint8)[passed]
+        field.mark_dirty()
+        cover.mark_dirty()
+
+        if (p == 1).all() and np.array_equal(cover_fg, text_fg):
+            break
         await asyncio.sleep(0)
+
+    text.remove_gadget(cover)
@@ -5,11 +5,11 @@ from random import choice
 import numpy as np
 from numpy.typing import NDArray
 
-from ...colors import BLACK, WHITE, Color, gradient, lerp_colors
-from ...geometry import BezierCurve, Point, clamp, move_along_path, points_on_circle
+from ...colors import BLACK, WHITE, Color, gradient
+from ...geometry import Point, clamp, points_on_circle
 from ..text import Text
 from ..text_field import TextParticleField, particle_data_from_canvas
-from ._particle import Particle
+from ._particle import RNG, line_paths, quadratic_paths, random_colors
 
 STARS = "*✸✺✹✷✵✶⋆'.⬫⬪⬩⬨⬧⬦⬥"
 UNSTABLE = "◦◎◉●◉◎◦"
@@ -25,7 +25,6 @@ STAR_COLOR = Color.from_hex("4a4a4d")
 STAR_GRADIENT = gradient(STAR_COLOR, WHITE, 6)
 TOP_COLOR = Color.from_hex("8a008a")
 MIDDLE_COLOR = Color.from_hex("00d1ff")
-RNG = np.random.default_rng()
 
 
 async def black_hole_effect(text: Text):
@@ -51,16 +50,13 @@ async def black_hole_effect(text: Text):
         size_hint={"height_hint": 1.0, "width_hint": 1.0},
     )
 
-    all_particles = list(Particle.iter_from_field(field))
-
-    positions = (RNG.random((field.nparticles, 2)) * text.size).astype(int)
-    for particle, position in zip(all_particles, positions):
-        particle.final_char = particle.cell["char"]
-        particle.final_fg_color = Color(*particle.cell["fg_color"].tolist())
-        particle.final_pos = particle.pos
-        particle.cell["char"] = choice(STARS)
-        particle.cell["fg_color"] = choice(STAR_GRADIENT)
-        particle.pos = position
+    n = field.nparticles
+    final_chars = field.particle_cells["char"].copy()
+    final_fg_colors = field.particle_cells["fg_color"].copy()
+    final_positions = field.particle_positions.copy()
+    field.particle_cells["char"] = RNG.choice(list(STARS), n)
+    field.particle_cells["fg_color"] = random_colors(STAR_GRADIENT, n)
+    field.particle_positions = (RNG.random((n, 2)) * text.size).astype(int)
 
     black_hole = TextParticleField(
         size_hint={"height_hint": 1.0, "width_hint": 1.0}, is_transparent=True
@@ -70,11 +66,9 @@ async def black_hole_effect(text: Text):
     nparticles = black_hole_radius * 3
     black_hole.particle_positions = field.particle_positions[-nparticles:]
     black_hole.particle_cells = field.particle_cells[-nparticles:]
-    black_hole_particles = list(Particle.iter_from_field(black_hole))
 
     field.particle_positions = field.particle_positions[:-nparticles]
     field.particle_cells = field.particle_cells[:-nparticles]
-    other_particles = all_particles[:-nparticles]
 
     circle_positions = points_on_circle(black_hole.nparticles, black_hole_radius)
     black_hole_positions = circle_positions.copy()
@@ -83,21 +77,16 @@ async def black_hole_effect(text: Text):
 
     text.add_gadgets(field, black_hole)
 
-    await _forming(black_hole_particles, black_hole_positions)
+    await _forming(black_hole, black_hole_positions)
 
     rot = _rotating(black_hole, circle_positions, black_hole_center)
     rotate_task = asyncio.create_task(rot)
 
-    await _consuming(other_particles, black_hole_positions, black_hole_center)
+    await _consuming(field, black_hole_positions, black_hole_center)
 
     rotate_task.cancel()
 
-    await _collapsing(
-        black_hole_particles,
-        black_hole.particle_positions,
-        black_hole_center,
-        black_hole_radius,
-    )
+    await _collapsing(black_hole, black_hole_center, black_hole_radius)
 
     field.particle_positions = np.vstack(
         [field.particle_positions, black_hole.particle_positions]
@@ -107,33 +96,24 @@ async def black_hole_effect(text: Text):
     await _point_char(black_hole, black_hole_center)
     text.remove_gadget(black_hole)
 
-    await _exploding(all_particles, black_hole_center)
+    await _exploding(
+        field, black_hole_center, final_chars, final_fg_colors, final_positions
+    )
 
     text.remove_gadget(field)
 
 
-async def _forming(particles: list[Particle], positions: NDArray[np.float32]):
-    for particle in particles:
-        particle.cell["char"] = "✸"
-        particle.cell["fg_color"] = WHITE
-
-    paths = [
-        [BezierCurve(np.array([particle.pos, position], float))]
-        for particle, position in zip(particles, positions)
-    ]
-
-    speed = len(particles)
-    motions = [
-        move_along_path(particle, path, speed=speed, easing="in_out_sine")
-        for particle, path in zip(particles, paths)
-    ]
-
-    tasks = []
-    for motion in motions:
-        tasks.append(asyncio.create_task(motion))
-        await asyncio.sleep(1 / speed)
+async def _forming(black_hole: TextParticleField, positions: NDArray[np.float32]):
+    black_hole.particle_cells["char"] = "✸"
+    black_hole.particle_cells["fg_color"] = WHITE
 
-    await asyncio.gather(*tasks)
+    speed = black_hole.nparticles
+    await black_hole.move_particles(
+        line_paths(black_hole.particle_positions, positions),
+        speed=speed,
+        easing="in_out_sine",
+        delay=np.arange(speed) / speed,
+    )
 
 
 async def _rotating(
@@ -150,72 +130,52 @@ async def _rotating(
         new_positions[:, 1] *= 2
         new_positions += center
         black_hole.particle_positions = new_positions.astype(int)
+        black_hole.mark_dirty()
         i += 1
         i %= 100
         await asyncio.sleep(0.01)
 
 
 async def _consuming(
-    particles: list[Particle], positions: NDArray[np.float32], center: Point
+    field: TextParticleField, positions: NDArray[np.float32], center: Point
 ):
-    particles.sort(key=lambda p: (p.pos.y - center.y) ** 2 + (p.pos.x - center.x) ** 2)
-
-    paths = [
-        [BezierCurve(np.array([particle.pos, choice(positions), center]))]
-        for particle in particles
-    ]
-
-    def create_fade(particle):
-        start_color = particle.cell["fg_color"]
-
-        def fade_particle(p):
-            particle.cell["fg_color"] = lerp_colors(start_color, BLACK, p)
-
-        return fade_particle
-
-    motions = [
-        move_along_path(
-            particle, path, speed=20, easing="in_exp", on_progress=create_fade(particle)
-        )
-        for particle, path in zip(particles, paths)
-    ]
-
-    tasks = []
-    nconsumes = clamp(int(len(particles) / 10), 2, 15)
-    while motions:
-        for motion in motions[:nconsumes]:
-            tasks.append(asyncio.create_task(motion))
-        motions = motions[nconsumes:]
-        nconsumes += 1
-        await asyncio.sleep(0.10)
+    distances = ((field.particle_positions - center) ** 2).sum(axis=1)
+    order = np.argsort(distances, kind="stable")
+    nparticles = len(order)
+
+    paths = quadratic_paths(
+        field.particle_positions[order],
+        positions[RNG.integers(len(positions), size=nparticles)],
+        center,
+    )
 
-    await asyncio.gather(*tasks)
+    # Particles are consumed in growing groups every tenth of a second.
+    delay = np.empty(nparticles)
+    nconsumes = clamp(int(nparticles / 10), 2, 15)
+    start = 0
+    group_delay = 0.0
+    while start < nparticles:
+        delay[start : start + nconsumes] = group_delay
+        start += nconsumes
+        nconsumes += 1
+        group_delay += 0.1
 
+    start_colors = field.particle_cells["fg_color"][order]
 
-async def _collapsing(
-    particles: list[Particle],
-    positions: NDArray[np.float32],
-    center: Point,
-    radius: int,
-):
-    new_pos = (positions - center).astype(float)
-    new_pos *= (radius + 3) / radius
-    new_pos += center
+    def fade(p):
+        field.lerp_particle_colors(order, start_colors, BLACK, p)
 
-    paths = []
-    for particle, position in zip(particles, new_pos):
-        particle_path = [
-            BezierCurve(np.array([particle.pos, position])),
-            BezierCurve(np.array([position, center])),
-        ]
-        paths.append(particle_path)
+    await field.move_particles(
+        paths, order, speed=20, easing="in_exp", delay=delay, on_progress=fade
+    )
 
-    motions = [
-        move_along_path(particle, path, speed=20, easing="in_exp")
-        for particle, path in zip(particles, paths)
-    ]
 
-    await asyncio.gather(*motions)
+async def _collapsing(black_hole: TextParticleField, center: Point, radius: int):
+    positions = black_hole.particle_positions.astype(float)
+    new_pos = (positions - center) * (radius + 3) / radius + center
+    await black_hole.move_particles(
+        line_paths(positions, new_pos, center), speed=20, easing="in_exp"
+    )
 
 
 async def _point_char(black_hole: TextParticleField, center: Point):
@@ -225,48 +185,37 @@ async def _point_char(black_hole: TextParticleField, center: Point):
         for char in UNSTABLE:
             black_hole.particle_cells[0]["char"] = char
             black_hole.particle_cells[0]["fg_color"] = choice(UNSTABLE_COLORS)
+            black_hole.mark_dirty()
             await asyncio.sleep(0.05)
 
 
-async def _exploding(particles: list[Particle], center: Point):
-    nearby_paths = []
-    final_paths = []
-    for particle in particles:
-        particle.pos = center
-        particle.cell["char"] = particle.final_char
-        particle.cell["fg_color"] = choice(UNSTABLE_COLORS)
-        near_point = choice(points_on_circle(6, 5))
-        near_point[1] *= 2
-        near_point += particle.final_pos
-        nearby_paths.append([BezierCurve(np.array([particle.pos, near_point]))])
-        final_paths.append([BezierCurve(np.array([near_point, particle.final_pos]))])
-
-    nearby_motions = [
-        move_along_path(particle, path, speed=20, easing="out_exp")
-        for particle, path in zip(particles, nearby_paths)
-    ]
-
-    await asyncio.gather(*nearby_motions)
-
-    def create_fade(particle):
-        start_color = particle.cell["fg_color"]
-
-        def fade_particle(p):
-            particle.cell["fg_color"] = lerp_colors(
-                start_color, particle.final_fg_color, p
-            )
-
-        return fade_particle
-
-    final_motions = [
-        move_along_path(
-            particle,
-            path,
-            speed=7,
-            easing="in_cubic",
-            on_progress=create_fade(particle),
-        )
-        for particle, path in zip(particles, final_paths)
-    ]
-
-    await asyncio.gather(*final_motions)
+async def _exploding(
+    field: TextParticleField,
+    center: Point,
+    final_chars: NDArray[np.str_],
+    final_fg_colors: NDArray[np.uint8],
+    final_positions: NDArray[np.int_],
+):
+    field.particle_positions[:] = center
+    field.particle_cells["char"] = final_chars
+    field.particle_cells["fg_color"] = random_colors(UNSTABLE_COLORS, field.nparticles)
+
+    near_points = points_on_circle(6, 5)[RNG.integers(6, size=field.nparticles)]
+    near_points[:, 1] *= 2
+    near_points += final_positions
+
+    await field.move_particles(
+        line_paths(center, near_points), speed=20, easing="out_exp"
+    )
+
+    start_colors = field.particle_cells["fg_color"].copy()
+
+    def fade(p):
+        field.lerp_particle_colors(slice(None), start_colors, final_fg_colors, p)
+
+    await field.move_particles(
+        line_paths(near_points, final_positions),
+        speed=7,
+        easing="in_cubic",
+        on_progress=fade,
+    )
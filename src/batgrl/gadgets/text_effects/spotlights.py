@@ -73,14 +73,14 @@ def _draw_spotlights(
     out_fg[:] = in_fg
     out_bg[:] = in_bg
     weighted = np.zeros_like(in_fg, float)
+    h, w, _ = in_fg.shape
+    ys, xs = np.indices((h, w)).astype(float)
+    xs /= 2
     for spotlight in spotlights:
-        h, w, _ = in_fg.shape
         y, x = spotlight.pos
         x /= 2
-        ys, xs = np.indices((h, w)).astype(float)
-        xs /= 2
 
-        distances = ((ys - y) ** 2 + (xs - x) ** 2) ** 0.5
+        distances = np.hypot(ys - y, xs - x)
         distances[distances > spotlight.radius] = np.inf
         weights = np.exp(-spotlight.falloff * distances)
         color = np.array(spotlight.color, float)
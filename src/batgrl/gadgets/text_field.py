@@ -3,11 +3,16 @@ A text particle field.
 
 A particle field specializes in handling many single "pixel" children.
 """
-from typing import Any
+import asyncio
+from collections.abc import Callable
+from math import comb
+from time import monotonic
+from typing import Any, Literal
 
 import numpy as np
 from numpy.typing import NDArray
 
+from ..easings import Easing, ease_array
 from ..geometry import clamp
 from .gadget import (
     Cell,
@@ -20,7 +25,7 @@ from .gadget import (
     SizeHintDict,
     cell,
 )
-from .text_tools import cell_sans
+from .text_tools import cell_bytes, cell_sans
 from .texture_tools import _composite
 
 __all__ = ["TextParticleField", "particle_data_from_canvas", "Point", "Size"]
@@ -34,6 +39,11 @@ class TextParticleField(Gadget):
     setting particle positions, chars, and color pairs. This is more efficient than
     rendering many 1x1 gadgets.
 
+    Particles are animated in bulk with :meth:`move_particles` and
+    :meth:`lerp_particle_colors`, which update whole index arrays of particles at
+    once. If several particles share a position, the particle with the greatest
+    index is painted.
+
     Parameters
     ----------
     particle_positions : NDArray[np.int32] | None, default: None
@@ -122,6 +132,10 @@ class TextParticleField(Gadget):
 
     Methods
     -------
+    move_particles(paths, indices=None, ...)
+        Move particles along paths of Bezier curves.
+    lerp_particle_colors(indices, start, end, p, ...)
+        Linearly interpolate particle colors.
     particles_from_cells(cells)
         Return positions and cells of non-whitespace characters of a Cell array.
     on_size()
@@ -150,6 +164,8 @@ class TextParticleField(Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -228,14 +244,111 @@ class TextParticleField(Gadget):
         """Number of particles in particle field."""
         return len(self.particle_positions)
 
+    def lerp_particle_colors(
+        self,
+        indices: NDArray[np.intp] | slice,
+        start: NDArray[np.uint8],
+        end: NDArray[np.uint8],
+        p: float | NDArray[np.float64],
+        color: Literal["fg_color", "bg_color"] = "fg_color",
+    ):
+        """
+        Linearly interpolate particle colors.
+
+        Parameters
+        ----------
+        indices : NDArray[np.intp] | slice
+            Indices of particles to color.
+        start : NDArray[np.uint8]
+            Start color or colors with shape `(N, 3)`.
+        end : NDArray[np.uint8]
+            End color or colors with shape `(N, 3)`.
+        p : float | NDArray[np.float64]
+            Proportion or proportions from `start` to `end`.
+        color : Literal["fg_color", "bg_color"], default: "fg_color"
+            Which color of particles to interpolate.
+        """
+        start = np.asarray(start, float)
+        end = np.asarray(end, float)
+        p = np.asarray(p, float)[..., None]
+        self.particle_cells[color][indices] = (start + (end - start) * p).round()
+        self.mark_dirty()
+
+    async def move_particles(
+        self,
+        paths: NDArray[np.float64],
+        indices: NDArray[np.intp] | None = None,
+        *,
+        speed: float | NDArray[np.float64] = 1.0,
+        easing: Easing = "linear",
+        delay: float | NDArray[np.float64] = 0.0,
+        on_progress: Callable[[NDArray[np.float64]], None] | None = None,
+    ):
+        """
+        Move particles along paths of Bezier curves at some speed (in cells per
+        second).
+
+        All particles are moved together each frame. A particle doesn't move until
+        its delay has passed.
+
+        Parameters
+        ----------
+        paths : NDArray[np.float64]
+            Control points of each particle's path with shape `(N, C, D + 1, 2)`, where
+            `C` is the number of curves in each path and `D` is their degree.
+        indices : NDArray[np.intp] | None, default: None
+            Indices of moved particles. If not given, all particles are moved.
+        speed : float | NDArray[np.float64], default: 1.0
+            Speed or speeds of particles in approximately cells per second.
+        easing : Easing, default: "linear"
+            The easing used for movement.
+        delay : float | NDArray[np.float64], default: 0.0
+            Delay or delays in seconds before each particle starts moving.
+        on_progress : Callable[[NDArray[np.float64]], None] | None, default: None
+            Called each frame with eased progress of each particle.
+        """
+        if indices is None:
+            indices = np.arange(self.nparticles)
+        points, lengths = _sample_paths(np.asarray(paths, float))
+        total_lengths = lengths[:, -1]
+        speed = np.broadcast_to(np.asarray(speed, float), total_lengths.shape)
+        delay = np.broadcast_to(np.asarray(delay, float), total_lengths.shape)
+        start_time = monotonic()
+
+        while True:
+            await asyncio.sleep(0)
+
+            elapsed = (monotonic() - start_time - delay).clip(0)
+            distances = speed * elapsed
+            progress = np.ones_like(distances)
+            np.divide(distances, total_lengths, out=progress, where=total_lengths > 0)
+            progress.clip(0, 1, out=progress)
+            p = ease_array(easing, progress)
+
+            started = elapsed > 0
+            positions = _point_along_paths(points, lengths, p * total_lengths)
+            finished = progress == 1
+            positions[finished] = points[finished, -1]
+            self.particle_positions[indices[started]] = positions[started]
+            if on_progress is not None:
+                on_progress(p)
+            self.mark_dirty()
+
+            if finished.all():
+                return
+
     def _render(self, canvas: NDArray[Cell]):
         """Render visible region of gadget."""
-        chars = canvas[cell_sans("bg_color")]
+        chars = cell_bytes(canvas, *cell_sans("bg_color"))
         bg_color = canvas["bg_color"]
         offy, offx = self.absolute_pos
         ppos = self.particle_positions
-        pchars = self.particle_cells[cell_sans("bg_color")]
+        pchars = cell_bytes(self.particle_cells, *cell_sans("bg_color"))
         pbg_color = self.particle_cells["bg_color"]
+        if self.is_transparent:
+            not_whitespace = np.isin(
+                self.particle_cells["char"], (" ", "⠀"), invert=True
+            )
         for rect in self._region.rects():
             height = rect.bottom - rect.top
             width = rect.right - rect.left
@@ -243,13 +356,22 @@ class TextParticleField(Gadget):
             inbounds = (((0, 0) <= pos) & (pos < (height, width))).all(axis=1)
 
             if self.is_transparent:
-                not_whitespace = np.isin(pchars["char"], (" ", "⠀"), invert=True)
-                where_inbounds = np.nonzero(inbounds & not_whitespace)
+                where_inbounds = np.flatnonzero(inbounds & not_whitespace)
             else:
-                where_inbounds = np.nonzero(inbounds)
-            painted = pbg_color[where_inbounds]
+                where_inbounds = np.flatnonzero(inbounds)
 
+            # Sort particles by cell and keep the last particle in each cell, so each
+            # cell is painted once.
             ys, xs = pos[where_inbounds].T
+            cell_indices = ys * width + xs
+            order = np.argsort(cell_indices, kind="stable")
+            sorted_indices = cell_indices[order]
+            is_last = np.ones(len(order), bool)
+            np.not_equal(sorted_indices[1:], sorted_indices[:-1], out=is_last[:-1])
+            where_inbounds = where_inbounds[order[is_last]]
+            ys, xs = pos[where_inbounds].T
+
+            painted = pbg_color[where_inbounds]
             dst = rect.to_slices()
             if self.is_transparent:
                 background = bg_color[dst][ys, xs]
@@ -261,6 +383,55 @@ class TextParticleField(Gadget):
             chars[dst][ys, xs] = pchars[where_inbounds]
 
 
+def _sample_paths(
+    paths: NDArray[np.float64], samples: int = 16
+) -> tuple[NDArray[np.float64], NDArray[np.float64]]:
+    """
+    Sample paths of Bezier curves into polylines.
+
+    Parameters
+    ----------
+    paths : NDArray[np.float64]
+        Control points of paths with shape `(N, C, D + 1, 2)`.
+    samples : int, default: 16
+        Number of samples of each curve.
+
+    Returns
+    -------
+    tuple[NDArray[np.float64], NDArray[np.float64]]
+        Points of polylines with shape `(N, C * samples, 2)` and arc lengths at each
+        point with shape `(N, C * samples)`.
+    """
+    n, ncurves, npoints, _ = paths.shape
+    degree = npoints - 1
+    t = np.linspace(0, 1, samples)[:, None]
+    i = np.arange(npoints)
+    coef = np.array([comb(degree, k) for k in range(npoints)], float)
+    basis = coef * t**i * (1 - t) ** (degree - i)
+    points = np.einsum("sk,nckd->ncsd", basis, paths).reshape(n, -1, 2)
+    segment_lengths = np.linalg.norm(points[:, 1:] - points[:, :-1], axis=-1)
+    lengths = np.zeros(points.shape[:2])
+    np.cumsum(segment_lengths, axis=1, out=lengths[:, 1:])
+    return points, lengths
+
+
+def _point_along_paths(
+    points: NDArray[np.float64],
+    lengths: NDArray[np.float64],
+    distances: NDArray[np.float64],
+) -> NDArray[np.float64]:
+    """Return point at some distance along each polyline."""
+    rows = np.arange(len(points))
+    i = ((lengths <= distances[:, None]).sum(axis=1) - 1).clip(0, lengths.shape[1] - 2)
+    start = lengths[rows, i]
+    segment_length = lengths[rows, i + 1] - start
+    t = np.zeros_like(distances)
+    np.divide(distances - start, segment_length, out=t, where=segment_length > 0)
+    a = points[rows, i]
+    b = points[rows, i + 1]
+    return a + (b - a) * t.clip(0, 1)[:, None]
+
+
 def particle_data_from_canvas(
     canvas: NDArray[Cell]
 ) -> tuple[NDArray[np.int32], NDArray[Cell]]:
@@ -1,6 +1,12 @@
 """A text-pad gadget for multiline editable text."""
+from pygments.lexer import Lexer
+from pygments.style import Style
+
+from ..colors import Neptune
 from ..io import Key, KeyEvent, Mods, MouseButton, MouseEvent, PasteEvent
 from ._cursor import Cursor
+from ._syntax_highlighter import SyntaxHighlighter
+from ._text_document import Edit, TextDocument, column_index, line_cells, line_width
 from .behaviors.focusable import Focusable
 from .behaviors.grabbable import Grabbable
 from .behaviors.themable import Themable
@@ -15,7 +21,7 @@ from .gadget import (
 )
 from .scroll_view import ScrollView
 from .text import Text
-from .text_tools import is_word_char, str_width
+from .text_tools import is_word_char
 
 __all__ = ["TextPad", "Point", "Size"]
 
@@ -26,8 +32,18 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
 
     Supports pasting, mouse selection, and cursor navigation.
 
+    Text is stored as lines, and only the portion of text visible in the pad is
+    painted, so editing large documents stays responsive.
+
+    If a lexer is given, text is syntax highlighted. Only edited lines are re-lexed
+    and only visible lines are highlighted.
+
     Parameters
     ----------
+    lexer : pygments.lexer.Lexer | None, default: None
+        Lexer for syntax highlighting. If None, text isn't highlighted.
+    syntax_highlighting_style : type[pygments.style.Style], default: Neptune
+        A pygments style to use for syntax highlighting.
     alpha : float, default: 1.0
         Transparency of gadget.
     size : Size, default: Size(10, 10)
@@ -49,6 +65,10 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
 
     Attributes
     ----------
+    lexer : pygments.lexer.Lexer | None
+        Lexer for syntax highlighting.
+    syntax_highlighting_style : type[pygments.style.Style]
+        A pygments style to use for syntax highlighting.
     alpha : float
         Transparency of gadget.
     text : str
@@ -182,6 +202,8 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -207,6 +229,8 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
     def __init__(
         self,
         *,
+        lexer: Lexer | None = None,
+        syntax_highlighting_style: type[Style] = Neptune,
         alpha: float = 1.0,
         size: Size = Size(10, 10),
         pos: Point = Point(0, 0),
@@ -217,7 +241,8 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         is_enabled: bool = True,
     ):
         self._cursor = Cursor()
-        self._pad = Text(size=(1, 1))
+        self._pad = Gadget(size=(1, 1), is_transparent=True)
+        self._viewport = Text()
         self._scroll_view = ScrollView(
             size_hint={"height_hint": 1.0, "width_hint": 1.0},
             arrow_keys_enabled=False,
@@ -235,34 +260,74 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         )
         self._last_x = None
         self._selection_start = self._selection_end = None
-        self._line_lengths = [0]
-        self._undo_stack = []
-        self._redo_stack = []
-        self._undo_buffer = []
+        self._document = TextDocument()
+        self._highlighter: SyntaxHighlighter | None = None
+        self._lexer = lexer
+        self._syntax_highlighting_style = syntax_highlighting_style
+        self._update_highlighter()
+        self._undo_stack: list[list[Edit]] = []
+        self._redo_stack: list[list[Edit]] = []
+        self._undo_buffer: list[Edit] = []
         self._undo_buffer_type = "add"
         self.alpha = alpha
 
-        self._pad.add_gadget(self._cursor)
+        self._pad.add_gadgets(self._viewport, self._cursor)
         self._scroll_view.view = self._pad
         self.add_gadget(self._scroll_view)
+        self._pad.bind("pos", self._update_viewport)
+        self._pad.bind("size", self._update_viewport)
+        self._scroll_view.bind("size", self._update_viewport)
+
+    @property
+    def lexer(self) -> Lexer | None:
+        """Lexer for syntax highlighting. If None, text isn't highlighted."""
+        return self._lexer
+
+    @lexer.setter
+    def lexer(self, lexer: Lexer | None):
+        self._lexer = lexer
+        self._update_highlighter()
+        self._paint_viewport()
+
+    @property
+    def syntax_highlighting_style(self) -> type[Style]:
+        """A pygments style to use for syntax highlighting."""
+        return self._syntax_highlighting_style
+
+    @syntax_highlighting_style.setter
+    def syntax_highlighting_style(self, syntax_highlighting_style: type[Style]):
+        self._syntax_highlighting_style = syntax_highlighting_style
+        self._update_highlighter()
+        self._paint_viewport()
+
+    def _update_highlighter(self):
+        """Create a highlighter for current lexer and style."""
+        if self._lexer is None:
+            self._highlighter = None
+            # Clear styles of previous highlighter.
+            self._viewport.canvas[:] = self._viewport.default_cell
+        else:
+            self._highlighter = SyntaxHighlighter(
+                self._lexer, self._syntax_highlighting_style, self._document.lines
+            )
 
     @property
     def alpha(self) -> float:
         """Transparency of gadget."""
-        return self._pad.alpha
+        return self._viewport.alpha
 
     @alpha.setter
     def alpha(self, alpha: float):
-        self._pad.alpha = alpha
+        self._viewport.alpha = alpha
 
     @property
     def is_transparent(self) -> bool:
         """Whether gadget is transparent."""
-        return self._pad.is_transparent
+        return self._viewport.is_transparent
 
     @is_transparent.setter
     def is_transparent(self, is_transparent: bool):
-        self._pad.is_transparent = is_transparent
+        self._viewport.is_transparent = is_transparent
         self._scroll_view.is_transparent = is_transparent
 
     def update_theme(self):
@@ -273,14 +338,43 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
 
         self._cursor.bg_color = fg
         self._cursor.fg_color = bg
-        self._pad.canvas["fg_color"] = self._pad.default_fg_color = fg
-        self._pad.canvas["bg_color"] = self._pad.default_bg_color = bg
-        self._highlight_selection()
+        self._viewport.default_fg_color = fg
+        self._viewport.default_bg_color = bg
+        self._paint_viewport()
 
     def on_size(self):
         """Resize children on resize."""
         super().on_size()
-        self._pad.width = max(self._scroll_view.port_width, max(self._line_lengths) + 1)
+        self._update_pad_size()
+
+    def _update_pad_size(self):
+        """Fit pad to text."""
+        self._pad.size = (
+            len(self._document),
+            max(self._scroll_view.port_width, self._document.max_width + 1),
+        )
+
+    def _update_viewport(self):
+        """Move viewport to the visible portion of pad and repaint it."""
+        top, left = -self._pad.y, -self._pad.x
+        height, width = self._pad.size
+        self._viewport.pos = top, left
+        self._viewport.size = (
+            max(0, min(self._scroll_view.port_height, height - top)),
+            max(0, min(self._scroll_view.port_width, width - left)),
+        )
+        self._paint_viewport()
+
+    def _paint_viewport(self):
+        """Paint the lines of text visible in viewport."""
+        viewport = self._viewport
+        top, left = viewport.pos
+        height, width = viewport.size
+        chars = viewport.canvas["char"]
+        chars[:] = " "
+        for y in range(top, min(top + height, len(self._document))):
+            cells = line_cells(self._document.line(y), left, left + width)
+            chars[y - top, : len(cells)] = cells
         self._highlight_selection()
 
     def on_focus(self):
@@ -298,40 +392,34 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
             self._undo_buffer = []
             self._redo_stack.clear()
 
+    def _revert(self, edits: list[Edit]) -> list[Edit]:
+        """Revert edits in reverse order and return edits that revert them."""
+        reverted = []
+        for edit in reversed(edits):
+            if edit.is_insertion:
+                reverted.append(self._del_text(edit.start, edit.end))
+            else:
+                reverted.append(self._add_text(edit.start, edit.text))
+            self._selection_start = edit.selection_start
+            self._selection_end = edit.selection_end
+            self.cursor = edit.cursor
+        return reverted
+
     def undo(self):
         """Undo previous edit."""
         self._move_undo_buffer_to_stack()
         if self._undo_stack:
-            redo = []
-            for func, args, selection_start, selection_end, cursor in reversed(
-                self._undo_stack.pop()
-            ):
-                redo.append(func(*args))
-                self._selection_start = selection_start
-                self._selection_end = selection_end
-                self.cursor = cursor
-            self._redo_stack.append(redo)
+            self._redo_stack.append(self._revert(self._undo_stack.pop()))
 
     def redo(self):
         """Redo previous undo."""
         if self._redo_stack and not self._undo_buffer:
-            undo = []
-            for func, args, selection_start, selection_end, cursor in reversed(
-                self._redo_stack.pop()
-            ):
-                undo.append(func(*args))
-                self._selection_start = selection_start
-                self._selection_end = selection_end
-                self.cursor = cursor
-            self._undo_stack.append(undo)
+            self._undo_stack.append(self._revert(self._redo_stack.pop()))
 
     @property
     def text(self) -> str:
         """The text pad's text."""
-        return "\n".join(
-            "".join(row[:line_length])
-            for row, line_length in zip(self._pad.canvas["char"], self._line_lengths)
-        )
+        return self._document.text
 
     @text.setter
     def text(self, text: str):
@@ -359,8 +447,10 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         self._highlight_selection()
 
     def _highlight_selection(self):
-        colors = self._pad.canvas[["fg_color", "bg_color"]]
-        colors[:] = self._pad.default_fg_color, self._pad.default_bg_color
+        viewport = self._viewport
+        top, left = viewport.pos
+        colors = viewport.canvas[["fg_color", "bg_color"]]
+        colors[:] = viewport.default_fg_color, viewport.default_bg_color
 
         if self._selection_start != self._selection_end:
             if self._selection_start > self._selection_end:
@@ -371,16 +461,18 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
                 ey, ex = self._selection_end
 
             highlight = self.color_theme.text_pad_selection_highlight
-            ll = self._line_lengths
-            if sy == ey:
-                colors[sy, sx:ex] = highlight
-            else:
-                colors[sy, sx : ll[sy]] = highlight
-                colors[ey, :ex] = highlight
-                for i in range(sy + 1, ey):
-                    colors[i, : ll[i]] = highlight
-        else:  # If no selection or selection is empty, add line highlight.
-            colors[self.cursor.y, :] = self.color_theme.text_pad_line_highlight
+            for y in range(max(sy, top), min(ey + 1, top + viewport.height)):
+                start = sx if y == sy else 0
+                end = ex if y == ey else self._document.width(y)
+                colors[y - top, max(0, start - left) : max(0, end - left)] = highlight
+        elif 0 <= self.cursor.y - top < viewport.height:
+            # If no selection or selection is empty, add line highlight.
+            colors[self.cursor.y - top] = self.color_theme.text_pad_line_highlight
+
+        if self._highlighter is not None:
+            self._highlighter.paint(viewport.canvas, top, left)
+
+        viewport.mark_dirty()
 
     @property
     def is_selecting(self) -> bool:
@@ -395,8 +487,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
     @property
     def end_text_point(self) -> Point:
         """Point after last character in text."""
-        ll = self._line_lengths
-        return Point(len(ll) - 1, ll[-1])
+        return self._document.end
 
     @property
     def page_lines(self) -> int:
@@ -417,111 +508,48 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         if self.has_nonempty_selection:
             return self._del_text(self._selection_start, self._selection_end)
 
-    def _del_text(self, start: Point, end: Point):
-        ll = self._line_lengths
-
-        pad = self._pad
-        canvas = pad.canvas
+    def _del_text(self, start: Point, end: Point) -> Edit:
+        document = self._document
 
         if start > end:
             start, end = end, start
 
-        sy, sx = start
         ey, ex = end
-
         # ! If one of the following conditions is true, something went wrong.
-        if ey >= len(ll):
-            ey = len(ll) - 1
-        if ex > ll[ey]:
-            ex = ll[ey]
-
-        contents = "\n".join(
-            "".join(
-                canvas["char"][y, sx if y == sy else None : ex if y == ey else ll[y]]
-            )
-            for y in range(sy, ey + 1)
-        )
+        if ey >= len(document):
+            ey = len(document) - 1
+        if ex > document.width(ey):
+            ex = document.width(ey)
+        end = Point(ey, ex)
+
         selection_start = self._selection_start
         selection_end = self._selection_end
         cursor = self.cursor
 
-        len_end = ll[ey] - ex
-        len_start = ll[sy] = sx + len_end
-
-        canvas[sy, sx:len_start] = canvas[ey, ex : ex + len_end]
-        canvas[sy, len_start:] = pad.default_cell
-
-        remaining = canvas[ey + 1 :]
-        canvas[sy + 1 : sy + 1 + len(remaining)] = remaining
-        pad.height -= ey - sy
-
-        del ll[sy + 1 : ey + 1]
-        pad.width = max(max(ll) + 1, self._scroll_view.port_width)
+        contents = document.delete(start, end)
+        if self._highlighter is not None:
+            self._highlighter.edit(start[0], ey + 1, 1)
+        self._update_pad_size()
 
         self.unselect()
         self._last_x = None
         self.cursor = start
-        return self._add_text, [start, contents], selection_start, selection_end, cursor
-
-    def _add_text(self, pos: Point, text: str):
-        y, x = pos
-        pad = self._pad
-        ll = self._line_lengths
-        line_remaining = pad.canvas[y, x : ll[y]].copy()
+        self._paint_viewport()
+        return Edit(start, end, contents, False, selection_start, selection_end, cursor)
 
+    def _add_text(self, pos: Point, text: str) -> Edit:
         selection_start = self._selection_start
         selection_end = self._selection_end
         cursor = self.cursor
 
-        lines = text.split("\n")  # DO NOT USE `splitlines`.
-        if len(lines) == 1:
-            [line] = lines
-            width_line = str_width(line)
-
-            ll[y] += width_line
-            if ll[y] >= pad.width:
-                pad.width = ll[y] + 1
+        end = self._document.insert(pos, text)
+        if self._highlighter is not None:
+            self._highlighter.edit(pos[0], pos[0] + 1, end.y - pos[0] + 1)
+        self._update_pad_size()
 
-            pad.add_str(line, pos=(y, x))
-            pad.canvas[y, x + width_line : ll[y]] = line_remaining
-
-            self.cursor = y, x + width_line
-        else:
-            first, *lines, last = lines
-            newlines = len(lines) + 1
-            width_last = str_width(last)
-            last_y = y + newlines
-
-            pad.height += newlines
-            pad.canvas[y + newlines + 1 :] = pad.canvas[y + 1 : -newlines]
-            pad.canvas[y, x : ll[y]] = pad.default_cell
-
-            ll[y] = x + str_width(first)
-            for i, line in enumerate(lines, start=y + 1):
-                ll.insert(i, str_width(line))
-            ll.insert(last_y, width_last + str_width("".join(line_remaining["char"])))
-
-            max_width = max(ll)
-            if max_width >= pad.width:
-                pad.width = max_width + 1
-
-            pad.add_str(first, pos=(y, x))
-            for i, line in enumerate(lines, start=y + 1):
-                pad.add_str(line.ljust(pad.width), pos=(i, 0))
-
-            pad.add_str(last, pos=(last_y, 0))
-            pad.canvas[last_y, width_last : ll[last_y]] = line_remaining
-            pad.canvas[last_y, ll[last_y] :] = pad.default_cell
-
-            self.cursor = last_y, width_last
-
-        return (
-            self._del_text,
-            [cursor, self.cursor],
-            selection_start,
-            selection_end,
-            cursor,
-        )
+        self.cursor = end
+        self._paint_viewport()
+        return Edit(pos, end, text, True, selection_start, selection_end, cursor)
 
     def move_cursor_left(self, n: int = 1):
         """Move cursor left `n` characters."""
@@ -529,10 +557,11 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         y, x = self._cursor.pos
 
         while n > 0:
-            text_before_cursor = "".join(self._pad.canvas["char"][y, :x])
+            line = self._document.line(y)
+            text_before_cursor = line[: column_index(line, x)]
             nchars_before_cursor = len(text_before_cursor)
             if n <= nchars_before_cursor:
-                x = str_width(text_before_cursor[:-n])
+                x = line_width(text_before_cursor[:-n])
                 break
 
             if y == 0:
@@ -540,7 +569,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
                 break
 
             y -= 1
-            x = self._line_lengths[y]
+            x = self._document.width(y)
             n -= nchars_before_cursor + 1
 
         self.cursor = y, x
@@ -551,16 +580,15 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         y, x = self._cursor.pos
 
         while n > 0:
-            text_after_cursor = "".join(
-                self._pad.canvas["char"][y, x : self._line_lengths[y]]
-            )
+            line = self._document.line(y)
+            text_after_cursor = line[column_index(line, x) :]
             nchars_after_cursor = len(text_after_cursor)
             if n <= nchars_after_cursor:
-                x += str_width(text_after_cursor[:n])
+                x += line_width(text_after_cursor[:n])
                 break
 
             if y == self.end_text_point.y:
-                x = self._line_lengths[y]
+                x = self._document.width(y)
                 break
 
             y += 1
@@ -578,7 +606,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
 
         if y > 0:
             y = max(0, y - n)
-            x = min(self._last_x, self._line_lengths[y])
+            x = min(self._last_x, self._document.width(y))
         else:
             x = 0
 
@@ -594,7 +622,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
 
         if y < ey:
             y = min(ey, y + n)
-            x = min(self._last_x, self._line_lengths[y])
+            x = min(self._last_x, self._document.width(y))
         else:
             x = ex
 
@@ -612,7 +640,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
 
             last_x = self.cursor.x
 
-            current_char = self._pad.canvas[self.cursor]["char"]
+            current_char = self._document.char(self.cursor)
             if not first_char_found:
                 if not current_char.isspace():
                     first_char_found = True
@@ -635,7 +663,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
 
             last_x = self.cursor.x
 
-            current_char = self._pad.canvas[self.cursor]["char"]
+            current_char = self._document.char(self.cursor)
             if not first_char_found:
                 if not current_char.isspace():
                     first_char_found = True
@@ -733,7 +761,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
             self.move_cursor_left()
             if last_x == self.cursor.x:
                 break
-            if not is_word_char(self._pad.canvas[self.cursor]["char"]):
+            if not is_word_char(self._document.char(self.cursor)):
                 self.move_cursor_right()
                 break
             last_x = self.cursor.x
@@ -741,7 +769,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         self.select()
         last_x = self.cursor.x
         while True:
-            if not is_word_char(self._pad.canvas[self.cursor]["char"]):
+            if not is_word_char(self._document.char(self.cursor)):
                 break
             self.move_cursor_right()
             if last_x == self.cursor.x:
@@ -785,7 +813,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         self.unselect()
         self._last_x = None
         y = self.cursor.y
-        self.cursor = y, self._line_lengths[y]
+        self.cursor = y, self._document.width(y)
 
     def _shift_left(self):
         self.select()
@@ -828,7 +856,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         self.select()
         self._last_x = None
         y = self.cursor.y
-        self.cursor = y, self._line_lengths[y]
+        self.cursor = y, self._document.width(y)
 
     def _escape(self):
         if self.has_nonempty_selection:
@@ -917,7 +945,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
             super().grab(mouse_event)
 
             y, x = self._pad.to_local(mouse_event.position)
-            x = min(x, self._line_lengths[y])
+            x = min(x, self._document.width(y))
 
             if not mouse_event.mods.shift:
                 self.unselect()
@@ -929,7 +957,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
         """Update selection on grab update."""
         if self._pad.collides_point(mouse_event.position):
             y, x = self._pad.to_local(mouse_event.position)
-            x = min(x, self._line_lengths[y])
+            x = min(x, self._document.width(y))
             self.cursor = y, x
         else:
             cy, cx = self.cursor
@@ -945,7 +973,7 @@ class TextPad(Themable, Grabbable, Focusable, Gadget):
                 if cx > 0:
                     self.move_cursor_left()
             elif x >= w:
-                if cx < self._line_lengths[cy]:
+                if cx < self._document.width(cy):
                     self.move_cursor_right()
 
     def ungrab(self, mouse_event):
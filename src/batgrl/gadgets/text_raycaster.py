@@ -3,7 +3,15 @@
 import numpy as np
 from numpy.typing import NDArray
 
-from .raycaster import RaycasterCamera, Sprite
+from .raycaster import (
+    RaycasterCamera,
+    Sprite,
+    _cast_rays,
+    _column_heights,
+    _project_sprites,
+    _wall_tex_x,
+    _wall_texels,
+)
 from .text import (
     Cell,
     Point,
@@ -175,6 +183,8 @@ class TextRaycaster(Text):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -248,7 +258,6 @@ class TextRaycaster(Text):
         self._side_shade = 2
         self._shade_diff = self._shades - self._side_shade
         # Buffers
-        self._pos_int = np.zeros((2,), dtype=int)
         self._pos_frac = np.zeros((2,), dtype=float)
 
         self.on_size()
@@ -301,112 +310,73 @@ class TextRaycaster(Text):
         self.canvas["char"] = " "
         self.canvas["char"][self.height // 2 :, ::2] = self.ascii_map[1]
 
-        for column in range(self.width):
-            self._cast_ray(column)
-
+        self._cast_walls()
         self._cast_sprites()
+        self.mark_dirty()
+
+    def _cast_walls(self):
+        """Paint walls of every column."""
+        camera_pos = self.camera.pos
+        ray_angles = self._rotated_angles
+        distance, side, texture_index, _ = _cast_rays(
+            self.caster_map,
+            camera_pos,
+            ray_angles,
+            self._deltas,
+            self._steps,
+            self._sides,
+            self.max_hops,
+        )
+        self._column_distances[:] = distance
 
-    def _cast_ray(self, column):
-        """Cast a ray for a given column of the screen."""
-        camera = self.camera
-        camera_pos = camera.pos
-        caster_map = self.caster_map
-
-        ray_pos = self._pos_int
-        ray_pos[:] = camera_pos
-
-        ray_angle = self._rotated_angles[column]
-        delta = self._deltas[column]
-        step = self._steps[column]
-        sides = self._sides[column]
-
-        # Cast a ray until we hit a wall or hit max_hops
-        for _ in range(self.max_hops):
-            side = 0 if sides[0] < sides[1] else 1
-            sides[side] += delta[side]
-            ray_pos[side] += step[side]
-
-            if texture_index := caster_map[tuple(ray_pos)]:
-                # Distance from wall to camera plane.
-                # Note that distance of wall to camera is not used
-                # as it would result in a "fish-eye" effect.
-                distance = (
-                    ray_pos[side] - camera_pos[side] + (0 if step[side] == 1 else 1)
-                ) / ray_angle[side]
-                break
-        else:  # No walls in range.
-            distance = 10000
-
-        self._column_distances[column] = distance
-
-        column_height = int(self.height / distance) if distance else 10000
-        if column_height == 0:
-            return
-
-        # Start and end y-coordinates of column.
-        half_height = self.height >> 1
-        half_column = column_height >> 1
-        if half_column > half_height:
-            half_column = half_height
-
-        start = half_height - half_column
-        end = half_height + half_column
-        drawn_height = end - start
-
-        shade = min(drawn_height, self._shade_diff)
-        if side:
-            shade += self._side_shade
-
-        shade_buffer = np.full(drawn_height, shade)
-        wall_texture = self.wall_textures[texture_index - 1]
-        tex_h, tex_w = wall_texture.shape
+        column_height, _, start, end = _column_heights(self.height, distance)
+        columns = np.arange(len(distance))
+        painted = (texture_index != 0) & (column_height != 0)
 
         # Exactly where wall was hit by ray as a percentage of its width.
-        wall_x = (camera_pos[1 - side] + distance * ray_angle[1 - side]) % 1
-
-        # Use above percentage to grab the column of the texture we need.
-        tex_x = int(wall_x * tex_w)
-        if (-1 if side == 1 else 1) * ray_angle[side] < 0:  # Sign correction.
-            tex_x = tex_w - tex_x - 1
-
-        # Interpolate texture onto column
-        offset = (column_height - drawn_height) / 2
-        ratio = tex_h / column_height
-        texture_start = offset * ratio
-        texture_end = (offset + drawn_height) * ratio
-        tex_ys = np.linspace(
-            texture_start, texture_end, num=drawn_height, endpoint=False, dtype=int
-        )
-        shade_buffer += self._shade_values[wall_texture[tex_ys, tex_x]]
-        np.clip(shade_buffer, 1, self._shades, out=shade_buffer)
-
-        # Paint column.
-        self.canvas["char"][:, ::-1][start:end, column] = self.ascii_map[shade_buffer]
+        other_side = 1 - side
+        wall_x = (
+            camera_pos[other_side] + distance * ray_angles[columns, other_side]
+        ) % 1
+        ray_angle = ray_angles[columns, side]
+        flip = np.where(side == 1, -ray_angle, ray_angle) < 0  # Sign correction.
+
+        shade = np.minimum(end - start, self._shade_diff)
+        shade[side == 1] += self._side_shade
+
+        # Paint columns of walls that share a texture all at once.
+        chars = self.canvas["char"][:, ::-1]
+        for index in np.unique(texture_index[painted]).tolist():
+            wall_texture = self.wall_textures[index - 1]
+            tex_h, tex_w = wall_texture.shape
+            wall_columns = columns[painted & (texture_index == index)]
+            ys, xs, tex_ys, tex_xs = _wall_texels(
+                wall_columns,
+                column_height[wall_columns],
+                start[wall_columns],
+                end[wall_columns],
+                _wall_tex_x(wall_x[wall_columns], flip[wall_columns], tex_w),
+                tex_h,
+            )
+            shades = shade[xs] + self._shade_values[wall_texture[tex_ys, tex_xs]]
+            np.clip(shades, 1, self._shades, out=shades)
+            chars[ys, xs] = self.ascii_map[shades]
 
     def _cast_sprites(self):
         """Render all sprites."""
         h, w = self.size
         half_w = w / 2
 
-        camera = self.camera
-        camera_pos = camera.pos
         sprites = self.sprites
+        if not sprites:
+            return
+
         sprite_textures = self.sprite_textures
         column_distances = self._column_distances
-
-        for sprite in sprites:
-            sprite.relative = camera_pos - sprite.pos
-
-        sprites.sort()
-
-        # Camera Inverse used to calculate transformed position of sprites.
-        cam_inv = np.linalg.inv(-camera._plane)
+        projected = _project_sprites(sprites, self.camera)
 
         # Draw each sprite from furthest to closest.
-        for sprite in sprites:
-            # Transformed position of sprites due to camera position.
-            y, x = sprite.relative @ cam_inv
-
+        for sprite, (y, x) in zip(sprites, projected.tolist()):
             if y <= 0:
                 # Sprite is behind camera, don't draw it.
                 continue
@@ -1,8 +1,7 @@
 """Tools for text."""
 
-from bisect import bisect
 from functools import lru_cache
-from operator import itemgetter
+from typing import Literal
 
 import numpy as np
 from numpy.typing import NDArray
@@ -14,19 +13,55 @@ from ._char_widths import CHAR_WIDTHS
 
 __all__ = [
     "Cell",
+    "Dither",
     "add_text",
     "binary_to_box",
     "binary_to_braille",
     "cell",
+    "cell_bytes",
     "char_width",
+    "char_widths",
+    "codepoint_widths",
+    "gray_to_braille",
     "is_word_char",
+    "rgb_to_box",
+    "rgb_to_braille",
     "smooth_horizontal_bar",
     "smooth_vertical_bar",
     "str_width",
 ]
 
 
-@lru_cache(maxsize=1024)
+_ASTRAL_BLOCK_SIZE = 256
+"""Number of code points in each block of the astral width table."""
+
+
+def _build_width_tables() -> tuple[NDArray[np.uint8], NDArray[np.uint8], NDArray]:
+    """
+    Build a dense width table of the basic multilingual plane and a two-level width
+    table of the astral planes.
+
+    Most blocks of astral code points have the same widths, so astral widths are
+    stored as an index of unique blocks.
+    """
+    widths = np.ones(0x110000, np.uint8)
+    for low, high, width in CHAR_WIDTHS:
+        widths[low : high + 1] = width
+
+    blocks = widths[0x10000:].reshape(-1, _ASTRAL_BLOCK_SIZE)
+    unique_blocks, block_index = np.unique(blocks, axis=0, return_inverse=True)
+    return widths[:0x10000].copy(), unique_blocks, block_index.reshape(-1)
+
+
+_BMP_WIDTHS, _ASTRAL_BLOCKS, _ASTRAL_INDEX = _build_width_tables()
+_BMP_WIDTHS_BYTES = _BMP_WIDTHS.tobytes()
+"""BMP widths as bytes for fast scalar lookup."""
+_ASTRAL_BLOCKS_BYTES = _ASTRAL_BLOCKS.tobytes()
+"""Astral width blocks as bytes for fast scalar lookup."""
+_ASTRAL_OFFSETS: list[int] = (_ASTRAL_INDEX * _ASTRAL_BLOCK_SIZE).tolist()
+"""Offset of each astral block into `_ASTRAL_BLOCKS_BYTES`."""
+
+
 def char_width(char: str) -> int:
     """
     Return the column width of a character.
@@ -45,18 +80,64 @@ def char_width(char: str) -> int:
         return 0
 
     char_ord = ord(char)
-    i = bisect(CHAR_WIDTHS, char_ord, key=itemgetter(0))
-    if i == 0:
-        return 1
+    if char_ord < 0x10000:
+        return _BMP_WIDTHS_BYTES[char_ord]
+
+    block, offset = divmod(char_ord - 0x10000, _ASTRAL_BLOCK_SIZE)
+    return _ASTRAL_BLOCKS_BYTES[_ASTRAL_OFFSETS[block] + offset]
+
+
+def codepoint_widths(codepoints: NDArray[np.integer]) -> NDArray[np.uint8]:
+    """
+    Return the column widths of an array of code points.
+
+    Parameters
+    ----------
+    codepoints : NDArray[np.integer]
+        An array of unicode code points.
+
+    Returns
+    -------
+    NDArray[np.uint8]
+        The column width of each code point.
+    """
+    codepoints = np.asarray(codepoints)
+    if codepoints.size == 0:
+        return np.zeros(codepoints.shape, np.uint8)
+    if codepoints.max() < 0x10000:
+        return _BMP_WIDTHS[codepoints]
+
+    widths = np.empty(codepoints.shape, np.uint8)
+    is_bmp = codepoints < 0x10000
+    widths[is_bmp] = _BMP_WIDTHS[codepoints[is_bmp]]
+    block, offset = np.divmod(codepoints[~is_bmp] - 0x10000, _ASTRAL_BLOCK_SIZE)
+    widths[~is_bmp] = _ASTRAL_BLOCKS[_ASTRAL_INDEX[block], offset]
+    return widths
+
+
+def char_widths(chars: NDArray[np.str_]) -> NDArray[np.uint8]:
+    """
+    Return the column widths of an array of characters.
+
+    Parameters
+    ----------
+    chars : NDArray[np.str_]
+        An array of single characters, such as the ``"char"`` field of a canvas.
+        Empty strings have width 0.
 
-    _, high, width = CHAR_WIDTHS[i - 1]
-    if char_ord <= high:
-        return width
+    Returns
+    -------
+    NDArray[np.uint8]
+        The column width of each character.
+    """
+    return codepoint_widths(np.ascontiguousarray(chars, "<U1").view("<u4"))
 
-    return 1
+
+def _str_to_codepoints(chars: str) -> NDArray[np.uint32]:
+    """Return code points of a string."""
+    return np.frombuffer(chars.encode("utf-32-le", "surrogatepass"), "<u4")
 
 
-@lru_cache(maxsize=256)
 def str_width(chars: str) -> int:
     """
     Return the total column width of a string.
@@ -71,7 +152,11 @@ def str_width(chars: str) -> int:
     int
         The total column width of the string.
     """
-    return sum(map(char_width, chars))
+    if chars.isascii() and chars.isprintable():
+        return len(chars)
+    if len(chars) < 32:
+        return sum(map(char_width, chars))
+    return int(codepoint_widths(_str_to_codepoints(chars)).sum())
 
 
 def is_word_char(char: str) -> bool:
@@ -114,6 +199,49 @@ def cell_sans(*names: str) -> list[str]:
     return [name for name in Cell.names if name not in names]
 
 
+@lru_cache
+def _cell_byte_slice(*names: str) -> slice:
+    """Slice of the bytes of a Cell spanned by fields in names."""
+    fields = sorted((Cell.fields[name][1], Cell[name].itemsize) for name in names)
+    start = fields[0][0]
+    stop = sum(fields[-1])
+    if sum(itemsize for _, itemsize in fields) != stop - start:
+        raise ValueError(f"Fields {names} aren't contiguous.")
+    return slice(start, stop)
+
+
+def cell_bytes(cells: NDArray[Cell], *names: str) -> NDArray[np.uint8]:
+    """
+    Return a uint8 view of the raw bytes of a Cell array.
+
+    Unlike multi-field indexing (e.g., ``canvas[["bold", "italic"]]``), the returned
+    array isn't structured, so assignments and comparisons through it are plain
+    byte-wise operations.
+
+    Parameters
+    ----------
+    cells : NDArray[Cell]
+        A Cell array whose last axis is contiguous.
+    *names : str
+        Fields to view. Fields must be adjacent in a Cell. If no fields are given,
+        all bytes of each cell are viewed.
+
+    Returns
+    -------
+    NDArray[np.uint8]
+        A view of `cells` with a new last axis of the bytes of the viewed fields.
+
+    Raises
+    ------
+    ValueError
+        If fields aren't contiguous.
+    """
+    raw = cells[..., None].view(np.uint8)
+    if names:
+        return raw[..., _cell_byte_slice(*names)]
+    return raw
+
+
 def cell(
     char: str = " ",
     bold: bool = False,
@@ -190,10 +318,46 @@ def _coerce_cell(char: NDArray[Cell] | str, default: NDArray[Cell]) -> NDArray[C
     return default
 
 
-def _parse_batgrl_md(text: str) -> tuple[Size, list[list[NDArray[Cell]]]]:
+_STYLES = ("bold", "italic", "underline", "strikethrough", "overline")
+"""Style fields of a Cell."""
+
+_StyledChar = np.dtype([("char", "U1"), *((style, "?") for style in _STYLES)])
+"""A Cell without colors. Fields are in the same order as a Cell."""
+
+
+def _line_to_cells(
+    codepoints: NDArray[np.uint32], styles: NDArray[np.bool_] | None = None
+) -> NDArray[_StyledChar]:
+    """
+    Convert the code points of a line (and optionally the styles of each code point)
+    to a row of cells.
+
+    Zero-width characters are dropped and full-width characters are followed by a
+    ``""`` cell with the same style.
+    """
+    widths = codepoint_widths(codepoints)
+    visible = widths > 0
+    codepoints = codepoints[visible]
+    widths = widths[visible]
+    cells = np.zeros(widths.sum(dtype=int), _StyledChar)
+    cells["char"][np.cumsum(widths) - widths] = codepoints.view("<U1")
+    if styles is not None:
+        char_of_cell = np.repeat(np.arange(len(widths)), widths)
+        styles = styles[visible][char_of_cell]
+        for i, style in enumerate(_STYLES):
+            cells[style] = styles[:, i]
+    return cells
+
+
+def _lines_size(lines: list[NDArray[_StyledChar]]) -> Size:
+    """Minimum canvas size to fit lines."""
+    return Size(len(lines), max(map(len, lines)))
+
+
+def _parse_batgrl_md(text: str) -> tuple[Size, list[NDArray[_StyledChar]]]:
     """
     Parse batgrl markdown and return the minimum canvas size to fit text and
-    a list of lines of styled characters.
+    a list of rows of styled characters.
 
     #### Syntax for batgrl markdown
     - italic: `*this is italic text*`
@@ -209,53 +373,35 @@ def _parse_batgrl_md(text: str) -> tuple[Size, list[list[NDArray[Cell]]]]:
 
     Returns
     -------
-    tuple[Size, list[list[Cell]]]
-        Minimum canvas size to fit text and a list of lines of styled characters.
+    tuple[Size, list[NDArray[_StyledChar]]]
+        Minimum canvas size to fit text and a list of rows of styled characters.
     """
-    NO_CHAR = cell(char="")
     matches, escapes = find_md_tokens(text)
-    chars = [cell(char=char)[cell_sans("fg_color", "bg_color")] for char in text]
+    codepoints = _str_to_codepoints(text)
+    styles = np.zeros((len(codepoints), len(_STYLES)), bool)
+    is_char = np.ones(len(codepoints), bool)
     for before, start, end, after, style in matches:
-        chars[start - before : start] = [NO_CHAR] * before
-        chars[end : end + after] = [NO_CHAR] * after
-        for i in range(start, end):
-            chars[i][style] = True
-
-    for i in escapes:
-        chars[i] = NO_CHAR
+        is_char[start - before : start] = False
+        is_char[end : end + after] = False
+        styles[start:end, _STYLES.index(style)] = True
+    is_char[np.array(escapes, int)] = False
 
+    newlines = np.flatnonzero(is_char & (codepoints == ord("\n")))
     lines = []
-    line = []
-    line_width = max_width = 0
-
-    for char in chars:
-        ch = char["char"].item()
-        if ch == "":
-            continue
-
-        if ch == "\n":
-            lines.append(line)
-            line = []
-            if line_width > max_width:
-                max_width = line_width
-            line_width = 0
-        else:
-            width = char_width(ch)
-            line_width += width
-            if width > 0:
-                line.append(char)
-
-    lines.append(line)
-    if line_width > max_width:
-        max_width = line_width
-
-    return Size(len(lines), max_width), lines
+    for start, stop in zip([0, *(newlines + 1).tolist()], [*newlines.tolist(), None]):
+        line_chars = is_char[start:stop]
+        lines.append(
+            _line_to_cells(
+                codepoints[start:stop][line_chars], styles[start:stop][line_chars]
+            )
+        )
+    return _lines_size(lines), lines
 
 
-def _text_to_cells(text: str) -> tuple[Size, list[list[NDArray[Cell]]]]:
+def _text_to_cells(text: str) -> tuple[Size, list[NDArray[_StyledChar]]]:
     """
-    Convert some text to a list of lists of Cells and the minimum canvas size to fit
-    them.
+    Convert some text to a list of rows of unstyled characters and the minimum canvas
+    size to fit them.
 
     Parameters
     ----------
@@ -264,27 +410,15 @@ def _text_to_cells(text: str) -> tuple[Size, list[list[NDArray[Cell]]]]:
 
     Returns
     -------
-    tuple[Size, list[list[Cell]]]
-        Minimum canvas size to fit text and a list of lists of Cells.
+    tuple[Size, list[NDArray[_StyledChar]]]
+        Minimum canvas size to fit text and a list of rows of unstyled characters.
     """
-    lines = [
-        [cell(char=char)[cell_sans("fg_color", "bg_color")] for char in line]
-        for line in text.split("\n")
-    ]
-    line_width = 0
-    max_width = 0
-    for line in lines:
-        for char in line:
-            width = char_width(char["char"].item())
-            line_width += width
-        if line_width > max_width:
-            max_width = line_width
-        line_width = 0
-    return Size(len(lines), max_width), lines
+    lines = [_line_to_cells(_str_to_codepoints(line)) for line in text.split("\n")]
+    return _lines_size(lines), lines
 
 
 def _write_lines_to_canvas(lines, canvas, fg_color, bg_color):
-    """Write a list of lists of Cells to a canvas array."""
+    """Write a list of rows of styled characters to a canvas array."""
     _, columns = canvas.shape
     for cells, canvas_line, fg, bg in zip(
         lines,
@@ -292,31 +426,12 @@ def _write_lines_to_canvas(lines, canvas, fg_color, bg_color):
         canvas["fg_color"],
         canvas["bg_color"],
     ):
-        i = 0
-        for cell in cells:
-            if i >= columns:
-                break
-
-            width = char_width(cell["char"].item())
-            if width == 0:
-                continue
-
-            canvas_line[i] = cell
-            if fg_color is not None:
-                fg[i] = fg_color
-            if bg_color is not None:
-                bg[i] = bg_color
-
-            if width == 2 and i + 1 < columns:
-                empty_cell = cell.copy()
-                empty_cell["char"] = ""
-                canvas_line[i + 1] = empty_cell
-                if fg_color is not None:
-                    fg[i + 1] = fg_color
-                if bg_color is not None:
-                    bg[i + 1] = bg_color
-
-            i += width
+        n = min(len(cells), columns)
+        canvas_line[:n] = cells[:n]
+        if fg_color is not None:
+            fg[:n] = fg_color
+        if bg_color is not None:
+            bg[:n] = bg_color
 
 
 def add_text(
@@ -471,12 +586,27 @@ def smooth_horizontal_bar(
 
 _BRAILLE_ENUM = np.array([[1, 8], [2, 16], [4, 32], [64, 128]])
 _BOX_ENUM = np.array([[1, 4], [2, 8]])
+_BOX_CHARS = np.array(list(" ▘▖▌▝▀▞▛▗▚▄▙▐▜▟█"))
+"""Box chars indexed by box enum."""
+
+_BOX_PARTITIONS = np.array([[k >> i & 1 for k in range(8)] for i in range(4)], float)
+"""
+Quadrants of each 2x2 partition (as columns) in box enum order. The lower-right
+quadrant is always background, so each split of a cell into two colors appears once.
+"""
 
-vectorized_chr = np.vectorize(chr)
-"""Vectorized `chr`."""
+_BAYER_4X4 = (
+    np.array([[0, 8, 2, 10], [12, 4, 14, 6], [3, 11, 1, 9], [15, 7, 13, 5]]) + 0.5
+) / 16 - 0.5
+"""Ordered dithering threshold offsets in [-0.5, 0.5)."""
 
-vectorized_box_map = np.vectorize(" ▘▖▌▝▀▞▛▗▚▄▙▐▜▟█".__getitem__)
-"""Vectorized box enum to box char."""
+Dither = Literal["none", "ordered", "floyd-steinberg"]
+"""Dithering methods for converting grayscale textures to braille."""
+
+
+def _codes_to_chars(codes: NDArray[np.uint32]) -> NDArray[np.dtype("<U1")]:
+    """View code points as characters."""
+    return np.ascontiguousarray(codes, "<u4").view("<U1")
 
 
 def binary_to_braille(array_4x2: NDArray[np.bool_]) -> NDArray[np.dtype("<U1")]:
@@ -494,9 +624,8 @@ def binary_to_braille(array_4x2: NDArray[np.bool_]) -> NDArray[np.dtype("<U1")]:
     NDArray[np.dtype("<U1")]
         A numpy array of braille unicode characters.
     """
-    return vectorized_chr(
-        np.sum(array_4x2 * _BRAILLE_ENUM, axis=(2, 3), initial=0x2800)
-    )
+    codes = np.tensordot(array_4x2, _BRAILLE_ENUM, axes=2) + 0x2800
+    return _codes_to_chars(codes)
 
 
 def binary_to_box(array_2x2: NDArray[np.bool_ | np.uint]) -> NDArray[np.dtype("<U1")]:
@@ -514,4 +643,161 @@ def binary_to_box(array_2x2: NDArray[np.bool_ | np.uint]) -> NDArray[np.dtype("<
     NDArray[np.dtype("<U1")]
         A numpy array of box unicode characters.
     """
-    return vectorized_box_map(np.sum(array_2x2 * _BOX_ENUM, axis=(2, 3)))
+    return _BOX_CHARS[np.tensordot(array_2x2, _BOX_ENUM, axes=2)]
+
+
+def _pack_braille(dots: NDArray[np.bool_]) -> NDArray[np.dtype("<U1")]:
+    """Convert a (4h, 2w)-shaped boolean array of dots into braille characters."""
+    h = dots.shape[0] // 4
+    w = dots.shape[1] // 2
+    codes = np.full((h, w), 0x2800, np.uint32)
+    for (y, x), bit in np.ndenumerate(_BRAILLE_ENUM):
+        codes += dots[y : 4 * h : 4, x : 2 * w : 2] * np.uint32(bit)
+    return _codes_to_chars(codes)
+
+
+def _floyd_steinberg(gray: NDArray[np.uint8], threshold: int) -> NDArray[np.bool_]:
+    """
+    Binarize a grayscale texture with Floyd-Steinberg error diffusion.
+
+    A pixel's error is only diffused to pixels right of it or below it, so pixels on
+    the same anti-diagonal ``x + 2 * y`` are independent and are quantized together.
+    """
+    h, w = gray.shape
+    work = np.zeros((h + 1, w + 2), np.float32)
+    work[:h, 1:-1] = gray
+    binary = np.zeros((h, w), bool)
+    all_ys = np.arange(h)
+    for t in range(w + 2 * h - 2):
+        ys = all_ys[max(0, (t - w) // 2 + 1) : t // 2 + 1]
+        xs = t - 2 * ys + 1
+        old = work[ys, xs]
+        on = old > threshold
+        binary[ys, xs - 1] = on
+        error = old - 255 * on
+        work[ys, xs + 1] += error * (7 / 16)
+        work[ys + 1, xs - 1] += error * (3 / 16)
+        work[ys + 1, xs] += error * (5 / 16)
+        work[ys + 1, xs + 1] += error * (1 / 16)
+    return binary
+
+
+def gray_to_braille(
+    gray: NDArray[np.uint8], threshold: int = 127, dither: Dither = "none"
+) -> NDArray[np.dtype("<U1")]:
+    """
+    Convert a (4h, 2w)-shaped grayscale texture into a (h, w) array of braille unicode
+    characters.
+
+    Dots are placed where pixels are lighter than `threshold`. Dithering preserves
+    the average lightness of regions at the cost of noise. Floyd-Steinberg dithering
+    gives the best results but is much slower than ordered dithering.
+
+    Parameters
+    ----------
+    gray : NDArray[np.uint8]
+        A (4h, 2w)-shaped grayscale texture.
+    threshold : int, default: 127
+        Pixels with values over this threshold are dots.
+    dither : Dither, default: "none"
+        Dithering method.
+
+    Returns
+    -------
+    NDArray[np.dtype("<U1")]
+        A numpy array of braille unicode characters.
+    """
+    if dither == "floyd-steinberg":
+        dots = _floyd_steinberg(gray, threshold)
+    elif dither == "ordered":
+        h, w = gray.shape
+        offsets = np.tile(_BAYER_4X4, (h // 4 + 1, w // 4 + 1))[:h, :w]
+        dots = gray > threshold + 255 * offsets
+    else:
+        dots = gray > threshold
+    return _pack_braille(dots)
+
+
+def rgb_to_braille(
+    rgb: NDArray[np.uint8],
+) -> tuple[NDArray[np.dtype("<U1")], NDArray[np.uint8], NDArray[np.uint8]]:
+    """
+    Convert a (4h, 2w)-shaped RGB texture into braille characters and colors.
+
+    Dots are placed where pixels are lighter than the average lightness of their cell.
+    The foreground and background colors of a cell are the average colors of its dots
+    and of the rest of its pixels.
+
+    Parameters
+    ----------
+    rgb : NDArray[np.uint8]
+        A (4h, 2w)-shaped RGB texture.
+
+    Returns
+    -------
+    tuple[NDArray[np.dtype("<U1")], NDArray[np.uint8], NDArray[np.uint8]]
+        A (h, w) array of braille unicode characters and (h, w, 3) arrays of
+        foreground and background colors.
+    """
+    h = rgb.shape[0] // 4
+    w = rgb.shape[1] // 2
+    cells = rgb[: 4 * h, : 2 * w].reshape(h, 4, w, 2, 3)
+
+    # Twice the HLS lightness of each pixel.
+    lightness = cells.max(axis=-1).astype(np.uint16) + cells.min(axis=-1)
+    dots = 8 * lightness > lightness.sum(axis=(1, 3), keepdims=True)
+
+    ndots = dots.sum(axis=(1, 3))[..., None]
+    fg_sum = (cells * dots[..., None]).sum(axis=(1, 3))
+    bg_sum = cells.sum(axis=(1, 3)) - fg_sum
+    fg = fg_sum // np.maximum(ndots, 1)
+    bg = bg_sum // np.maximum(8 - ndots, 1)
+    chars = _pack_braille(dots.reshape(4 * h, 2 * w))
+    return chars, fg.astype(np.uint8), bg.astype(np.uint8)
+
+
+def rgb_to_box(
+    rgb: NDArray[np.uint8],
+) -> tuple[NDArray[np.dtype("<U1")], NDArray[np.uint8], NDArray[np.uint8]]:
+    """
+    Convert a (2h, 2w)-shaped RGB texture into box characters and colors.
+
+    Each cell is split into the two colors that best fit its four quadrants: of every
+    way to split the quadrants into a foreground and background, the split whose
+    average colors have the least squared error is chosen.
+
+    Parameters
+    ----------
+    rgb : NDArray[np.uint8]
+        A (2h, 2w)-shaped RGB texture.
+
+    Returns
+    -------
+    tuple[NDArray[np.dtype("<U1")], NDArray[np.uint8], NDArray[np.uint8]]
+        A (h, w) array of box unicode characters and (h, w, 3) arrays of foreground
+        and background colors.
+    """
+    h = rgb.shape[0] // 2
+    w = rgb.shape[1] // 2
+    rgb = rgb[: 2 * h, : 2 * w]
+    # Quadrants in box enum order along the last axis.
+    quadrants = np.stack(
+        [rgb[0::2, 0::2], rgb[1::2, 0::2], rgb[0::2, 1::2], rgb[1::2, 1::2]], axis=-1
+    ).astype(float)
+
+    counts = _BOX_PARTITIONS.sum(axis=0)
+    fg_sums = quadrants @ _BOX_PARTITIONS
+    bg_sums = quadrants.sum(axis=-1, keepdims=True) - fg_sums
+
+    # The squared error of a split is the sum of squares of the quadrants minus the
+    # squared sums of each side over the number of quadrants on that side.
+    explained = (fg_sums**2).sum(axis=-2) / np.maximum(counts, 1)
+    explained += (bg_sums**2).sum(axis=-2) / (4 - counts)
+    best = explained.argmax(axis=-1)
+
+    index = best[..., None, None]
+    fg = np.take_along_axis(fg_sums, index, axis=-1)[..., 0]
+    bg = np.take_along_axis(bg_sums, index, axis=-1)[..., 0]
+    fg /= np.maximum(counts[best], 1)[..., None]
+    bg /= (4 - counts[best])[..., None]
+    return _BOX_CHARS[best], fg.astype(np.uint8), bg.astype(np.uint8)
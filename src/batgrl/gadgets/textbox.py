@@ -5,6 +5,7 @@ from numpy.typing import NDArray
 
 from ..io import Key, KeyEvent, Mods, MouseButton, MouseEvent, PasteEvent
 from ._cursor import Cursor
+from ._text_document import Edit
 from .behaviors.focusable import Focusable
 from .behaviors.grabbable import Grabbable
 from .behaviors.themable import Themable
@@ -232,6 +233,8 @@ class Textbox(Themable, Focusable, Grabbable, Gadget):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -293,9 +296,9 @@ class Textbox(Themable, Focusable, Grabbable, Gadget):
 
         self._selection_start = self._selection_end = None
         self._line_length = 0
-        self._undo_stack = []
-        self._redo_stack = []
-        self._undo_buffer = []
+        self._undo_stack: list[list[Edit]] = []
+        self._redo_stack: list[list[Edit]] = []
+        self._undo_buffer: list[Edit] = []
         self._undo_buffer_type = "add"
 
         self._box.add_gadgets(self._placeholder_gadget, self._cursor)
@@ -398,32 +401,29 @@ class Textbox(Themable, Focusable, Grabbable, Gadget):
             self._undo_buffer = []
             self._redo_stack.clear()
 
+    def _revert(self, edits: list[Edit]) -> list[Edit]:
+        """Revert edits in reverse order and return edits that revert them."""
+        reverted = []
+        for edit in reversed(edits):
+            if edit.is_insertion:
+                reverted.append(self._del_text(edit.start, edit.end))
+            else:
+                reverted.append(self._add_text(edit.start, edit.text))
+            self._selection_start = edit.selection_start
+            self._selection_end = edit.selection_end
+            self.cursor = edit.cursor
+        return reverted
+
     def undo(self):
         """Undo previous edit."""
         self._move_undo_buffer_to_stack()
         if self._undo_stack:
-            redo = []
-            for func, args, selection_start, selection_end, cursor in reversed(
-                self._undo_stack.pop()
-            ):
-                redo.append(func(*args))
-                self._selection_start = selection_start
-                self._selection_end = selection_end
-                self.cursor = cursor
-            self._redo_stack.append(redo)
+            self._redo_stack.append(self._revert(self._undo_stack.pop()))
 
     def redo(self):
         """Redo previous undo."""
         if self._redo_stack and not self._undo_buffer:
-            undo = []
-            for func, args, selection_start, selection_end, cursor in reversed(
-                self._redo_stack.pop()
-            ):
-                undo.append(func(*args))
-                self._selection_start = selection_start
-                self._selection_end = selection_end
-                self.cursor = cursor
-            self._undo_stack.append(undo)
+            self._undo_stack.append(self._revert(self._redo_stack.pop()))
 
     @property
     def text(self) -> str:
@@ -505,7 +505,7 @@ class Textbox(Themable, Focusable, Grabbable, Gadget):
         if self.has_nonempty_selection:
             return self._del_text(self._selection_start, self._selection_end)
 
-    def _del_text(self, start: int, end: int):
+    def _del_text(self, start: int, end: int) -> Edit:
         if start > end:
             start, end = end, start
 
@@ -528,9 +528,9 @@ class Textbox(Themable, Focusable, Grabbable, Gadget):
         self.unselect()
         self.cursor = start
 
-        return self._add_text, [start, contents], selection_start, selection_end, cursor
+        return Edit(start, end, contents, False, selection_start, selection_end, cursor)
 
-    def _add_text(self, x: int, text: str):
+    def _add_text(self, x: int, text: str) -> Edit:
         selection_start = self._selection_start
         selection_end = self._selection_end
         cursor = self.cursor
@@ -551,7 +551,7 @@ class Textbox(Themable, Focusable, Grabbable, Gadget):
         box.canvas[0, box_width:] = box.default_cell
 
         self.cursor = min(box_width, x + str_width(text))
-        return self._del_text, [x, self.cursor], selection_start, selection_end, cursor
+        return Edit(x, self.cursor, text, True, selection_start, selection_end, cursor)
 
     def move_cursor_left(self, n: int = 1):
         """Move cursor left `n` characters."""
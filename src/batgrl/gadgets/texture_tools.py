@@ -1,5 +1,9 @@
 """Tools for graphics."""
+import hashlib
+import os
+from collections import OrderedDict
 from pathlib import Path
+from threading import Lock, local
 from typing import Literal
 
 import cv2
@@ -8,11 +12,21 @@ from numpy.typing import NDArray
 
 from ..geometry import Point, Region, Size
 
-__all__ = ["Interpolation", "read_texture", "resize_texture", "composite"]
+__all__ = [
+    "Interpolation",
+    "read_texture",
+    "resize_texture",
+    "composite",
+    "TextureCache",
+    "texture_cache",
+]
 
 Interpolation = Literal["nearest", "linear", "cubic", "area", "lanczos"]
 """Interpolation methods for resizing graphic gadgets."""
 
+_SCRATCH = local()
+"""Per-thread scratch memory of :func:`_composite`."""
+
 Interpolation._to_cv_enum = {
     "linear": cv2.INTER_LINEAR,
     "cubic": cv2.INTER_CUBIC,
@@ -83,6 +97,166 @@ def resize_texture(
     )
 
 
+class TextureCache:
+    r"""
+    A least-recently-used cache of read-only textures.
+
+    Textures are keyed on the path, modification time, size, and interpolation of an
+    image, so gadgets showing the same image at the same size share one texture and
+    only the first of them reads and resizes it. The least recently used textures are
+    evicted when the cache exceeds its byte budget.
+
+    If :attr:`disk_cache` is set, decoded images are also saved there as raw RGBA and
+    later memory-mapped instead of decoded.
+
+    Cached textures are read-only. Copy a texture before modifying it.
+
+    Parameters
+    ----------
+    max_bytes : int, default: 256 * 2**20
+        Byte budget of cached textures.
+    disk_cache : Path | None, default: None
+        Directory of decoded images, or None to not cache decoded images on disk.
+
+    Attributes
+    ----------
+    max_bytes : int
+        Byte budget of cached textures.
+    disk_cache : Path | None
+        Directory of decoded images, or None to not cache decoded images on disk.
+    nbytes : int
+        Total bytes of cached textures.
+
+    Methods
+    -------
+    get(path, size=None, interpolation="linear")
+        Return a read-only texture of an image.
+    clear()
+        Remove all textures from the cache.
+    """
+
+    def __init__(self, max_bytes: int = 256 * 2**20, disk_cache: Path | None = None):
+        self._textures: OrderedDict[tuple, NDArray[np.uint8]] = OrderedDict()
+        self._lock = Lock()
+        self.nbytes = 0
+        """Total bytes of cached textures."""
+        self.disk_cache = disk_cache
+        """Directory of decoded images, or None to not cache decoded images on disk."""
+        self.max_bytes = max_bytes
+
+    @property
+    def max_bytes(self) -> int:
+        """Byte budget of cached textures. Setting this evicts textures over budget."""
+        return self._max_bytes
+
+    @max_bytes.setter
+    def max_bytes(self, max_bytes: int):
+        self._max_bytes = max_bytes
+        with self._lock:
+            self._evict()
+
+    def get(
+        self,
+        path: Path,
+        size: Size | None = None,
+        interpolation: Interpolation = "linear",
+    ) -> NDArray[np.uint8]:
+        """
+        Return a read-only texture of an image.
+
+        Parameters
+        ----------
+        path : Path
+            Path to image.
+        size : Size | None, default: None
+            Size of texture. If None, the texture is the original size of the image.
+        interpolation : Interpolation, default: "linear"
+            Interpolation used when resizing texture.
+
+        Returns
+        -------
+        NDArray[np.uint8]
+            A read-only uint8 RGBA array of the image.
+        """
+        path = path.absolute()
+        stat = path.stat()
+        image_key = str(path), stat.st_mtime_ns, stat.st_size
+        key = image_key if size is None else (*image_key, *size, interpolation)
+
+        with self._lock:
+            if (texture := self._textures.get(key)) is not None:
+                self._textures.move_to_end(key)
+                return texture
+
+        if size is None:
+            texture = self._read(path, image_key)
+        else:
+            texture = resize_texture(self.get(path), size, interpolation)
+        texture.flags.writeable = False
+
+        with self._lock:
+            if key not in self._textures:
+                self._textures[key] = texture
+                self.nbytes += texture.nbytes
+                self._evict()
+        return texture
+
+    def _read(self, path: Path, image_key: tuple) -> NDArray[np.uint8]:
+        """Read an image, from the disk cache if possible."""
+        if self.disk_cache is None:
+            return read_texture(path)
+
+        digest = hashlib.sha1(repr(image_key).encode()).hexdigest()
+        cached = self.disk_cache / f"{digest}.npy"
+        try:
+            return np.load(cached, mmap_mode="r")
+        except (OSError, ValueError):
+            pass
+
+        texture = read_texture(path)
+        self.disk_cache.mkdir(parents=True, exist_ok=True)
+        # Write to a temporary file first so a partial file is never loaded.
+        tmp = cached.with_name(f"{digest}.{os.getpid()}.tmp")
+        with tmp.open("wb") as file:
+            np.save(file, texture)
+        os.replace(tmp, cached)
+        return texture
+
+    def _evict(self):
+        """Evict least recently used textures until cache is within budget."""
+        while self.nbytes > self._max_bytes and self._textures:
+            _, texture = self._textures.popitem(last=False)
+            self.nbytes -= texture.nbytes
+
+    def clear(self):
+        """Remove all textures from the cache."""
+        with self._lock:
+            self._textures.clear()
+            self.nbytes = 0
+
+
+texture_cache = TextureCache()
+"""The texture cache used by image gadgets."""
+
+
+def _scratch(*shapes: tuple[int, ...]) -> list[NDArray[np.uint16]]:
+    """
+    Return uint16 arrays of given shapes. The memory is reused by the calling
+    thread's next call, so the arrays are only valid until then.
+    """
+    sizes = [int(np.prod(shape)) for shape in shapes]
+    buffer = getattr(_SCRATCH, "buffer", None)
+    if buffer is None or len(buffer) < sum(sizes):
+        buffer = _SCRATCH.buffer = np.empty(sum(sizes), np.uint16)
+
+    arrays = []
+    start = 0
+    for shape, size in zip(shapes, sizes):
+        arrays.append(buffer[start : start + size].reshape(shape))
+        start += size
+    return arrays
+
+
 def _composite(
     dest: NDArray[np.uint8],
     rgb: tuple[int] | NDArray[np.uint8],
@@ -93,12 +267,35 @@ def _composite(
     Composite a texture onto `dest`.
 
     This is an internal function used in various `_render()` methods.
+
+    Compositing is done in 16-bit fixed-point: with ``k = a * alpha``, each channel
+    becomes ``(dest * (255 - k) + rgb * k) / 255``, rounded to nearest. ``k`` is
+    computed with `alpha` in 8.8 fixed-point. Every step writes into per-thread
+    scratch arrays, so no temporaries are allocated.
     """
-    buffer = np.subtract(rgb, dest, dtype=float)
-    buffer *= a
-    buffer *= alpha
-    buffer /= 255
-    np.add(buffer, dest, out=dest, casting="unsafe")
+    if isinstance(a, int):
+        k = round(a * alpha)
+        buffer, product = _scratch(dest.shape, dest.shape)
+        np.multiply(rgb, k, out=product, dtype=np.uint16)
+        np.multiply(dest, 255 - k, out=buffer, dtype=np.uint16)
+    else:
+        buffer, product, k = _scratch(dest.shape, dest.shape, a.shape)
+        if alpha != 1.0:
+            np.multiply(a, round(alpha * 256), out=k, dtype=np.uint16)
+            k += 128
+            np.right_shift(k, 8, out=k)
+        else:
+            np.copyto(k, a)
+        np.multiply(rgb, k, out=product, dtype=np.uint16)
+        np.subtract(255, k, out=k)
+        np.multiply(dest, k, out=buffer, dtype=np.uint16)
+
+    buffer += product
+    # For x in [0, 255**2], with y = x + 128, (y + (y >> 8)) >> 8 == round(x / 255).
+    buffer += 128
+    np.right_shift(buffer, 8, out=product)
+    buffer += product
+    np.right_shift(buffer, 8, out=dest, casting="unsafe")
 
 
 def composite(
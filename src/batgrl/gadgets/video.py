@@ -1,15 +1,15 @@
 """A video gadget."""
 import asyncio
-import atexit
-import time
 import warnings
 from pathlib import Path
 from platform import uname
 
 import cv2
 import numpy as np
+from numpy.typing import NDArray
 
 from ..colors import ABLACK, AColor
+from ._video_decoder import open_stream
 from .graphics import (
     Graphics,
     Interpolation,
@@ -26,10 +26,28 @@ __all__ = ["Video", "Interpolation", "Point", "Size"]
 _IS_WSL: bool = uname().system == "Linux" and uname().release.endswith("Microsoft")
 
 
+def _resize_frame(
+    frame: NDArray[np.uint8], size: Size, interpolation: Interpolation
+) -> NDArray[np.uint8] | None:
+    """Resize and convert a BGR frame to a texture of a gadget of given size."""
+    h, w = size
+    if h == 0 or w == 0:
+        return None
+
+    # Resizing before converting means fewer pixels to convert.
+    resized = cv2.resize(
+        frame, (w, 2 * h), interpolation=Interpolation._to_cv_enum[interpolation]
+    )
+    return cv2.cvtColor(resized, cv2.COLOR_BGR2RGBA)
+
+
 class Video(Graphics):
     r"""
     A video gadget.
 
+    Frames are decoded and resized in a background thread. Video gadgets with the
+    same source share a decoder, so seeking one seeks all of them.
+
     Parameters
     ----------
     source : pathlib.Path | str | int
@@ -163,6 +181,8 @@ class Video(Graphics):
         Yield all descendents of this gadget (reverse postorder traversal).
     ancestors()
         Yield all ancestors of this gadget.
+    mark_dirty()
+        Mark gadget as needing to be repainted.
     bind(prop, callback)
         Bind `callback` to a gadget property.
     unbind(uid)
@@ -213,8 +233,13 @@ class Video(Graphics):
             is_visible=is_visible,
             is_enabled=is_enabled,
         )
+        self._frame_target: tuple[Size, Interpolation] = self.size, self.interpolation
+        """
+        Size and interpolation of prepared frames. Read by the decode thread, so it's
+        only ever replaced.
+        """
         self._current_frame = None
-        self._resource = None
+        self._stream = None
         self._video_task = None
         self.source = source
         self.loop = loop
@@ -239,71 +264,73 @@ class Video(Graphics):
         return isinstance(self._source, int)
 
     def _load_resource(self):
-        source = self.source
-
         if _IS_WSL and self.is_device:
             # Because WSL doesn't support most USB devices (yet?), and trying to open
             # one with cv2 will pollute the terminal with cv2 errors, we don't attempt
             # to open a device in this case and instead issue a warning.
             warnings.warn("device not available on WSL")
-            self._resource = None
+            self._stream = None
             return
 
-        if isinstance(source, Path):
-            source = str(source.absolute())
-
-        self._resource = cv2.VideoCapture(source)
-        atexit.register(self._resource.release)
+        self._stream = open_stream(self.source, self._prepare_frame)
 
     def _release_resource(self):
-        if self._resource is not None:
-            self._resource.release()
-            atexit.unregister(self._resource.release)
-            self._resource = None
+        if self._stream is not None:
+            self._stream.close()
+            self._stream = None
             self._current_frame = None
             self.clear()
 
-    def _time_delta(self) -> float:
-        return time.monotonic() - self._resource.get(cv2.CAP_PROP_POS_MSEC) / 1000
+    @property
+    def interpolation(self) -> Interpolation:
+        """Interpolation used when gadget is resized."""
+        return self._interpolation
+
+    @interpolation.setter
+    def interpolation(self, interpolation: Interpolation):
+        Graphics.interpolation.fset(self, interpolation)
+        self._frame_target = self.size, interpolation
+
+    def _prepare_frame(
+        self, frame: NDArray[np.uint8]
+    ) -> tuple[NDArray[np.uint8], NDArray[np.uint8] | None]:
+        """Prepare a decoded frame for display. Called from the decode thread."""
+        size, interpolation = self._frame_target
+        return frame, _resize_frame(frame, size, interpolation)
 
     def _display_current_frame(self):
-        h, w = self.size
-        if self._current_frame is None or h == 0 or w == 0:
-            return
-
-        self.texture = cv2.resize(
-            self._current_frame,
-            (w, 2 * h),
-            interpolation=Interpolation._to_cv_enum[self.interpolation],
-        )
+        if self._current_frame is not None:
+            texture = _resize_frame(self._current_frame, self.size, self.interpolation)
+            if texture is not None:
+                self.texture = texture
 
     async def _play_video(self):
-        if self._resource is None:
+        if self._stream is None:
             return
 
-        self._start_time = self._time_delta()
-
-        while self._resource.grab():
-            if self.is_device:
-                seconds_ahead = 0
-            elif (seconds_ahead := self._start_time - self._time_delta()) < 0:
-                continue
-
-            try:
-                await asyncio.sleep(seconds_ahead)
-            except asyncio.CancelledError:
-                return
-
-            _, frame = self._resource.retrieve()
-            self._current_frame = cv2.cvtColor(frame, cv2.COLOR_BGR2RGBA)
-            self._display_current_frame()
+        self._stream.play()
+
+        try:
+            while (item := await self._stream.next_frame()) is not None:
+                pts, (frame, texture) = item
+                await asyncio.sleep(max(0, self._stream.seconds_ahead(pts)))
+                self._current_frame = frame
+                h, w = self.size
+                if texture is not None and texture.shape[:2] == (2 * h, w):
+                    self.texture = texture
+                else:  # Resized while frame was prepared.
+                    self._display_current_frame()
+        except asyncio.CancelledError:
+            return
 
+        self._stream.pause()
         if self.loop:
             self.seek(0)
             self.play()
 
     def on_size(self):
         """Resize current frame on resize."""
+        self._frame_target = self.size, self.interpolation
         h, w = self.size
         self.texture = np.full((2 * h, w, 4), self.default_color, dtype=np.uint8)
         self._display_current_frame()
@@ -318,6 +345,8 @@ class Video(Graphics):
         """Pause video."""
         if self._video_task is not None:
             self._video_task.cancel()
+        if self._stream is not None:
+            self._stream.pause()
 
     def play(self) -> asyncio.Task:
         """
@@ -330,7 +359,7 @@ class Video(Graphics):
         """
         self.pause()
 
-        if self._resource is None:
+        if self._stream is None:
             self._load_resource()
 
         self._video_task = asyncio.create_task(self._play_video())
@@ -338,10 +367,8 @@ class Video(Graphics):
 
     def seek(self, time: float):
         """If supported, seek to certain time (in seconds) in the video."""
-        if self._resource is not None and not self.is_device:
-            self._resource.set(cv2.CAP_PROP_POS_MSEC, time * 1000)
-            self._resource.grab()
-            self._start_time = self._time_delta()
+        if self._stream is not None and not self.is_device:
+            self._stream.seek(time)
 
     def stop(self):
         """Stop video."""
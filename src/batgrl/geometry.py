@@ -289,29 +289,67 @@ class _Band:
         return y < self.y1
 
 
-def _merge(op: Callable[[bool, bool], bool], a: list[int], b: list[int]) -> list[int]:
+_AND = 0b1000
+_OR = 0b1110
+_SUB = 0b0100
+_XOR = 0b0110
+"""
+Set operations as truth tables. Bit `2 * inside_a + inside_b` of an operation is
+whether a point inside `a` and/or inside `b` is inside the result.
+"""
+
+
+def _merge(op: int, a: list[int], b: list[int]) -> list[int]:
     """Merge the walls of two bands given a set operation."""
+    # Both operands are never inside an empty band, so bit 0 of op is always unset.
+    if not b:
+        return a if op & 0b0100 else []
+    if not a:
+        return b if op & 0b0010 else []
+
     i = j = 0
-    inside_a = inside_b = inside_region = False
+    len_a = len(a)
+    len_b = len(b)
+    inside = 0  # 2 * inside_a + inside_b
+    inside_region = 0
     walls = []
 
-    while i < len(a) or j < len(b):
-        current_a = a[i] if i < len(a) else float("inf")
-        current_b = b[j] if j < len(b) else float("inf")
-        threshold = min(current_a, current_b)
-
-        if current_a == threshold:
-            inside_a = not inside_a
+    while i < len_a and j < len_b:
+        current_a = a[i]
+        current_b = b[j]
+        if current_a < current_b:
+            threshold = current_a
+            inside ^= 0b10
+            i += 1
+        elif current_b < current_a:
+            threshold = current_b
+            inside ^= 0b01
+            j += 1
+        else:
+            threshold = current_a
+            inside ^= 0b11
             i += 1
-
-        if current_b == threshold:
-            inside_b = not inside_b
             j += 1
 
-        if op(inside_a, inside_b) != inside_region:
-            inside_region = not inside_region
+        if op >> inside & 1 != inside_region:
+            inside_region ^= 1
             walls.append(threshold)
 
+    # Only one of the bands has walls remaining.
+    while i < len_a:
+        inside ^= 0b10
+        if op >> inside & 1 != inside_region:
+            inside_region ^= 1
+            walls.append(a[i])
+        i += 1
+
+    while j < len_b:
+        inside ^= 0b01
+        if op >> inside & 1 != inside_region:
+            inside_region ^= 1
+            walls.append(b[j])
+        j += 1
+
     return walls
 
 
@@ -356,9 +394,23 @@ class Region:
             else:
                 i += 1
 
-    def _merge_regions(
-        self, other: "Region", op: Callable[[bool, bool], bool]
-    ) -> "Region":
+    def _merge_regions(self, other: "Region", op: int) -> "Region":
+        # Fast paths for empty or vertically disjoint regions.
+        if (
+            not self.bands
+            or not other.bands
+            or self.bands[-1].y2 <= other.bands[0].y1
+            or other.bands[-1].y2 <= self.bands[0].y1
+        ):
+            if op == _AND:
+                return Region()
+            if op == _SUB:
+                return Region(self.bands.copy())
+            if not self.bands:
+                return Region(other.bands.copy())
+            if not other.bands:
+                return Region(self.bands.copy())
+
         bands = []
         i = j = 0
         scanline = -float("inf")
@@ -497,19 +549,19 @@ class Region:
     # TODO: in-place merge and iand, ior, iadd, isub, ixor methods
 
     def __and__(self, other: "Region") -> "Region":
-        return self._merge_regions(other, lambda a, b: a & b)
+        return self._merge_regions(other, _AND)
 
     def __or__(self, other: "Region") -> "Region":
-        return self._merge_regions(other, lambda a, b: a | b)
+        return self._merge_regions(other, _OR)
 
     def __add__(self, other: "Region") -> "Region":
-        return self._merge_regions(other, lambda a, b: a | b)
+        return self._merge_regions(other, _OR)
 
     def __sub__(self, other: "Region") -> "Region":
-        return self._merge_regions(other, lambda a, b: a & (not b))
+        return self._merge_regions(other, _SUB)
 
     def __xor__(self, other: "Region") -> "Region":
-        return self._merge_regions(other, lambda a, b: a ^ b)
+        return self._merge_regions(other, _XOR)
 
     def __bool__(self):
         return len(self.bands) > 0
@@ -535,10 +587,11 @@ class Region:
             A rect in the region.
         """
         for band in self.bands:
-            i = 0
-            while i < len(band.walls):
-                yield Rect(band.y1, band.y2, band.walls[i], band.walls[i + 1])
-                i += 2
+            y1 = band.y1
+            y2 = band.y2
+            walls = band.walls
+            for i in range(0, len(walls), 2):
+                yield Rect(y1, y2, walls[i], walls[i + 1])
 
     @classmethod
     def from_rect(cls, pos: Point, size: Size) -> "Region":
@@ -552,7 +605,9 @@ class Region:
         """
         y, x = pos
         h, w = size
-        return cls([_Band(y, y + h, (x, x + w))])
+        if h <= 0 or w <= 0:
+            return cls()
+        return cls([_Band(y, y + h, [x, x + w])])
 
     def __contains__(self, point: Point) -> bool:
         """Whether point is in region."""
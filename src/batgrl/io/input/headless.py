@@ -0,0 +1,83 @@
+"""Input for apps run without a terminal."""
+import asyncio
+from collections.abc import Callable, Iterator
+from contextlib import contextmanager
+from threading import Lock
+
+from ...geometry import Size
+from .events import KeyEvent, MouseEvent, PasteEvent, _PartialMouseEvent
+
+__all__ = ["HeadlessInput"]
+
+InputEvent = KeyEvent | MouseEvent | _PartialMouseEvent | PasteEvent | Size
+"""Events that can be sent to a headless input."""
+
+
+class HeadlessInput:
+    r"""
+    Input for apps run without a terminal.
+
+    Has the same interface as the platform input modules, but events are only created
+    by :meth:`send`.
+
+    Methods
+    -------
+    attach(callback)
+        Context manager that makes this input active in the current event loop.
+    raw_mode()
+        Context manager that does nothing; there is no terminal.
+    events()
+        Yield input events.
+    send(\*events)
+        Send input events.
+    """
+
+    def __init__(self):
+        self._events: list[InputEvent] = []
+        self._lock = Lock()
+        self._loop: asyncio.AbstractEventLoop | None = None
+        self._callback: Callable[[], None] | None = None
+
+    @contextmanager
+    def attach(self, callback: Callable[[], None]):
+        """Context manager that makes this input active in the current event loop."""
+        with self._lock:
+            self._loop = asyncio.get_running_loop()
+            self._callback = callback
+            if self._events:
+                self._loop.call_soon(callback)
+
+        try:
+            yield
+        finally:
+            with self._lock:
+                self._loop = self._callback = None
+
+    @contextmanager
+    def raw_mode(self):
+        """Context manager that does nothing; there is no terminal."""
+        yield
+
+    def events(self) -> Iterator[InputEvent]:
+        """Yield input events."""
+        with self._lock:
+            events, self._events = self._events, []
+        yield from events
+
+    def send(self, *events: InputEvent):
+        r"""
+        Send input events.
+
+        Events are dispatched in the event loop the input is attached to. Events sent
+        before the input is attached are dispatched once it is. Can be called from any
+        thread.
+
+        Parameters
+        ----------
+        \*events : InputEvent
+            Key, mouse, paste, or size events.
+        """
+        with self._lock:
+            self._events.extend(events)
+            if self._loop is not None:
+                self._loop.call_soon_threadsafe(self._callback)
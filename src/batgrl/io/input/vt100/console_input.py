@@ -10,6 +10,7 @@ import select
 import sys
 from codecs import getincrementaldecoder
 from collections.abc import Iterator
+from time import monotonic
 
 from ....geometry import Point, Size
 from ..events import Key, KeyEvent, PasteEvent, _PartialMouseEvent
@@ -17,15 +18,42 @@ from .ansi_escapes import ALT, ANSI_ESCAPES
 from .mouse_bindings import TERM_SGR, TYPICAL
 
 DECODER = getincrementaldecoder("utf-8")("surrogateescape")
-MOUSE_RE = re.compile("^" + re.escape("\x1b[") + r"(<[\d;]+[mM]|M...)\Z")
-MAX_ESCAPE_LENGTH = 20
+SGR_MOUSE_RE = re.compile(re.escape("\x1b[<") + r"\d+;\d+;\d+[mM]")
+"""Xterm SGR mouse escape, e.g., "Esc[<64;85;12M"."""
+PARTIAL_SGR_MOUSE_RE = re.compile(re.escape("\x1b[<") + r"[\d;]*\Z")
+"""An Xterm SGR mouse escape that's been cut-off by the end of input."""
+TYPICAL_MOUSE_LENGTH = 6
+"""Length of a typical mouse escape, e.g., "Esc[MaB*"."""
+PASTE_END = "\x1b[201~"
+ESCAPE_TIMEOUT = 0.05
 """
-Heuristic for the maximum length of an ansi escape. Longer max escape length will
-lengthen searches for ansi escapes in arbitrary data from stdin.
+Seconds to wait for the remainder of an escape cut-off by the end of input before
+parsing what has been received as is (e.g., a lone escape is the escape key).
 """
 STDIN = sys.stdin.fileno()
 
 _EVENTS = []
+_PENDING = ""
+"""Input cut-off in the middle of an escape, prepended to the next input."""
+_PENDING_TIME = 0.0
+"""Time input was last read."""
+
+
+def _build_trie(escapes: dict) -> dict:
+    """
+    Build a trie of escapes. Each node maps characters to child nodes and ``None`` to
+    the value of the escape ending at that node (if any).
+    """
+    trie = {}
+    for escape, value in escapes.items():
+        node = trie
+        for char in escape:
+            node = node.setdefault(char, {})
+        node[None] = value
+    return trie
+
+
+_ANSI_TRIE = _build_trie(ANSI_ESCAPES)
 
 
 def read_stdin() -> str:
@@ -62,60 +90,121 @@ def _create_mouse_event(data) -> _PartialMouseEvent | None:
         x -= 1
         y -= 1
 
-    if mouse_info is not None:
-        _EVENTS.append(_PartialMouseEvent(Point(y, x), *mouse_info))
+    if mouse_info is None:
+        return
 
+    _EVENTS.append(_PartialMouseEvent(Point(y, x), *mouse_info))
 
-def _find_longest_match(data: str) -> str:
-    """
-    Find an ANSI escape in data.
 
-    If an escape is found an event will be created and appended to `_EVENTS` and the
-    remaining data returned.
+def _parse(data: str, final: bool) -> int:
     """
-    for i in range(min(MAX_ESCAPE_LENGTH, len(data)), 0, -1):
-        prefix = data[:i]
-        suffix = data[i:]
+    Create events from data and append them to `_EVENTS`.
+
+    At each offset, the longest ANSI escape (or mouse escape) is matched by walking a
+    trie of escapes. Characters that don't start an escape are key events.
 
-        if MOUSE_RE.match(prefix) is not None:
-            _create_mouse_event(prefix)
-            return suffix
+    If data ends in the middle of an escape and `final` is false, parsing stops before
+    the escape.
 
-        match ANSI_ESCAPES.get(prefix):
+    Returns
+    -------
+    int
+        Offset of first unparsed character.
+    """
+    pos = 0
+    end = len(data)
+    while pos < end:
+        node = _ANSI_TRIE.get(data[pos])
+        if node is None:
+            _EVENTS.append(KeyEvent(data[pos]))
+            pos += 1
+            continue
+
+        key = node.get(None)
+        key_end = pos + 1
+        i = pos + 1
+        while i < end and (child := node.get(data[i])) is not None:
+            node = child
+            i += 1
+            if None in node:
+                key = node[None]
+                key_end = i
+        incomplete = i == end and len(node) > (None in node)
+
+        mouse_end = -1
+        if data.startswith("\x1b[<", pos):
+            if match := SGR_MOUSE_RE.match(data, pos):
+                mouse_end = match.end()
+            elif PARTIAL_SGR_MOUSE_RE.match(data, pos):
+                incomplete = True
+        elif data.startswith("\x1b[M", pos):
+            if end - pos >= TYPICAL_MOUSE_LENGTH:
+                mouse_end = pos + TYPICAL_MOUSE_LENGTH
+            else:
+                incomplete = True
+
+        if mouse_end >= key_end:
+            _create_mouse_event(data[pos:mouse_end])
+            pos = mouse_end
+            continue
+
+        if incomplete and not final:
+            return pos
+
+        match key:
             case None:
-                continue
+                _EVENTS.append(KeyEvent(data[pos]))
+                pos += 1
             case Key.Ignore:
-                return suffix
+                pos = key_end
             case Key.Paste:
-                paste_end = suffix.find("\x1b[201~")
+                paste_end = data.find(PASTE_END, key_end)
                 if paste_end == -1:
+                    if not final:
+                        return pos
                     # ! To end up here, a paste start ansi was found without the
                     # ! corresponding paste end. This shouldn't happen, so maybe an
                     # ! error should be logged. For now, instead, a paste event is
                     # ! created from the remainder of the data.
                     # ? Log this error?
-                    _EVENTS.append(PasteEvent(suffix))
-                    return ""
-                _EVENTS.append(PasteEvent(suffix[:paste_end]))
-                return suffix[paste_end + 6 :]
-            case KeyEvent.ESCAPE if suffix:
+                    _EVENTS.append(PasteEvent(data[key_end:]))
+                    return end
+                _EVENTS.append(PasteEvent(data[key_end:paste_end]))
+                pos = paste_end + len(PASTE_END)
+            case KeyEvent.ESCAPE if key_end < end:
                 # alt + character
-                _EVENTS.append(KeyEvent(suffix[0], ALT))
-                return suffix[1:]
+                _EVENTS.append(KeyEvent(data[key_end], ALT))
+                pos = key_end + 1
             case key:
                 _EVENTS.append(key)
-                return suffix
+                pos = key_end
+
+    return end
 
-    _EVENTS.append(KeyEvent(prefix))
-    return suffix
+
+def _flush_delay() -> float | None:
+    """
+    Return seconds until pending input is parsed as is, or ``None`` if there is no
+    pending input.
+    """
+    if not _PENDING:
+        return None
+    return max(0.0, _PENDING_TIME + ESCAPE_TIMEOUT - monotonic())
 
 
 def events() -> Iterator[KeyEvent | PasteEvent | Size | _PartialMouseEvent]:
     """Yield input events."""
-    data = "".join(iter(read_stdin, ""))
+    global _PENDING, _PENDING_TIME
 
-    while data:
-        data = _find_longest_match(data)
+    data = "".join(iter(read_stdin, ""))
+    if data:
+        _PENDING_TIME = monotonic()
+        final = False
+    else:
+        final = monotonic() - _PENDING_TIME >= ESCAPE_TIMEOUT
+
+    data = _PENDING + data
+    _PENDING = data[_parse(data, final) :]
 
     yield from _EVENTS
 
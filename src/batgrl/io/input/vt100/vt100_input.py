@@ -8,7 +8,7 @@ import tty
 from contextlib import contextmanager
 
 from ....geometry import Size
-from .console_input import _EVENTS, events
+from .console_input import _EVENTS, _flush_delay, events
 
 __all__ = [
     "attach",
@@ -25,13 +25,28 @@ def attach(callback):
     stdin = sys.stdin.fileno()
 
     loop = asyncio.get_event_loop()
-    loop.add_reader(stdin, callback)
+    flush_handle = None
+
+    def read_input():
+        nonlocal flush_handle
+        if flush_handle is not None:
+            flush_handle.cancel()
+            flush_handle = None
+
+        callback()
+
+        # If input ended in the middle of an escape, parse it anyways if the rest
+        # doesn't arrive soon.
+        if (delay := _flush_delay()) is not None:
+            flush_handle = loop.call_later(delay, read_input)
+
+    loop.add_reader(stdin, read_input)
 
     def on_resize(*_):
         w, h = os.get_terminal_size()
         # Create a size event and schedule event handler:
         _EVENTS.append(Size(h, w))
-        loop.call_soon_threadsafe(callback)
+        loop.call_soon_threadsafe(read_input)
 
     signal.signal(signal.SIGWINCH, on_resize)
 
@@ -39,6 +54,8 @@ def attach(callback):
         yield
 
     finally:
+        if flush_handle is not None:
+            flush_handle.cancel()
         loop.remove_reader(stdin)
         signal.signal(signal.SIGWINCH, signal.SIG_DFL)
 
@@ -0,0 +1,212 @@
+"""Streaming asciicast v2 recorder."""
+import gzip
+import json
+import time
+from pathlib import Path
+from queue import Full, Queue
+from threading import Thread
+from typing import BinaryIO
+
+from ...geometry import Size
+
+__all__ = ["AsciicastRecorder"]
+
+MAX_QUEUED_FRAMES = 1024
+"""Max frames waiting to be written before recording blocks."""
+CHUNK_SECONDS = 10.0
+"""Seconds of recording in each chunk of a compressed recording."""
+CHUNK_BYTES = 1_000_000
+"""Max uncompressed bytes in each chunk of a compressed recording."""
+
+
+class AsciicastRecorder:
+    """
+    Record output in asciicast v2 file format.
+
+    Frames are serialized and written by a background thread. An error writing the
+    recording stops the thread and is raised by the next call to :meth:`record` or
+    :meth:`close`.
+
+    If the path ends with ``.gz``, the recording is compressed in chunks, each a
+    separate gzip member, so the file is still a valid gzip file, but any chunk can be
+    decompressed on its own. An index of the start time and file offset of each chunk
+    is written to the path with an added ``.idx`` suffix as JSON, for seeking long
+    recordings.
+
+    Parameters
+    ----------
+    path : Path
+        Path of recording.
+    size : Size
+        Size of terminal.
+    env : dict[str, str]
+        Environment recorded in the header of the recording.
+
+    Attributes
+    ----------
+    path : Path
+        Path of recording.
+    is_compressed : bool
+        Whether recording is compressed.
+
+    Methods
+    -------
+    record(data)
+        Record output.
+    close()
+        Write remaining frames and stop recording.
+    """
+
+    def __init__(self, path: Path, size: Size, env: dict[str, str]):
+        self.path = path
+        self.is_compressed = path.suffix == ".gz"
+        self._queue: Queue[tuple[float, str] | None] = Queue(MAX_QUEUED_FRAMES)
+        self._initial_time = time.monotonic()
+        self._error: BaseException | None = None
+        """Error raised in the writer thread, if any."""
+
+        header = {
+            "version": 2,
+            "width": size.width,
+            "height": size.height,
+            "timestamp": int(time.time()),
+            "env": env,
+        }
+        self._thread = Thread(
+            target=self._write_frames,
+            args=(json.dumps(header) + "\n",),
+            daemon=True,
+            name="batgrl-asciicast",
+        )
+        self._thread.start()
+
+    def record(self, data: str):
+        """
+        Record output.
+
+        Blocks if too many frames are waiting to be written.
+
+        Parameters
+        ----------
+        data : str
+            Output written to terminal.
+        """
+        self._put((time.monotonic() - self._initial_time, data))
+
+    def close(self):
+        """Write remaining frames and stop recording."""
+        self._put(None)
+        self._thread.join()
+        self._raise_error()
+
+    def _put(self, item: tuple[float, str] | None):
+        """Queue an item for the writer thread unless it has stopped."""
+        while self._thread.is_alive():
+            try:
+                self._queue.put(item, timeout=0.1)
+            except Full:  # Recheck writer thread, which may have stopped on an error.
+                continue
+            return
+        self._raise_error()
+
+    def _raise_error(self):
+        """Raise the error that stopped the writer thread, if it hasn't been raised."""
+        if self._error is not None:
+            error, self._error = self._error, None
+            raise error
+
+    def _write_frames(self, header: str):
+        """Serialize and write queued frames until closed, storing any error."""
+        try:
+            self._write_recording(header)
+        except BaseException as e:
+            self._error = e
+
+    def _write_recording(self, header: str):
+        """Serialize and write queued frames until closed."""
+        with self.path.open("wb") as file:
+            if self.is_compressed:
+                index_path = self.path.with_name(f"{self.path.name}.idx")
+                writer = _ChunkedGzipWriter(file, index_path)
+            else:
+                writer = _PlainWriter(file)
+
+            writer.write(0.0, header)
+            while True:
+                # Serialize every waiting frame at once to reduce writes.
+                items = [self._queue.get()]
+                while not self._queue.empty():
+                    items.append(self._queue.get_nowait())
+
+                closed = items[-1] is None
+                if closed:
+                    items.pop()
+
+                if items:
+                    writer.write(
+                        items[0][0],
+                        "".join(
+                            f'[{elapsed:.6f}, "o", {json.dumps(data)}]\n'
+                            for elapsed, data in items
+                        ),
+                    )
+
+                if closed:
+                    writer.close()
+                    return
+
+
+class _PlainWriter:
+    """Write asciicast lines uncompressed."""
+
+    def __init__(self, file: BinaryIO):
+        self._file = file
+
+    def write(self, elapsed: float, lines: str):
+        """Write lines starting at `elapsed` seconds into recording."""
+        self._file.write(lines.encode())
+        self._file.flush()
+
+    def close(self):
+        """Finish writing."""
+
+
+class _ChunkedGzipWriter:
+    """Write asciicast lines as independently compressed gzip chunks with an index."""
+
+    def __init__(self, file: BinaryIO, index_path: Path):
+        self._file = file
+        self._index_path = index_path
+        self._index: list[tuple[float, int]] = []
+        self._chunk: list[bytes] = []
+        self._chunk_bytes = 0
+        self._chunk_start = 0.0
+
+    def write(self, elapsed: float, lines: str):
+        """Write lines starting at `elapsed` seconds into recording."""
+        if self._chunk and (
+            self._chunk_bytes >= CHUNK_BYTES
+            or elapsed - self._chunk_start >= CHUNK_SECONDS
+        ):
+            self._write_chunk()
+
+        if not self._chunk:
+            self._chunk_start = elapsed
+
+        data = lines.encode()
+        self._chunk.append(data)
+        self._chunk_bytes += len(data)
+
+    def _write_chunk(self):
+        """Compress and write current chunk and update index."""
+        self._index.append((self._chunk_start, self._file.tell()))
+        self._file.write(gzip.compress(b"".join(self._chunk)))
+        self._file.flush()
+        self._chunk.clear()
+        self._chunk_bytes = 0
+        self._index_path.write_text(json.dumps({"chunks": self._index}))
+
+    def close(self):
+        """Write remaining chunk."""
+        if self._chunk:
+            self._write_chunk()
@@ -0,0 +1,128 @@
+"""Measurement and pacing of output throughput."""
+from time import perf_counter
+
+__all__ = ["BandwidthMonitor"]
+
+_BLOCKED_WRITE = 0.002
+"""Writes taking at least this many seconds are assumed limited by the output."""
+_HEADROOM = 0.9
+"""Proportion of measured throughput budgeted, so that buffers downstream drain."""
+_SMOOTHING = 0.25
+"""Weight of each new throughput measurement."""
+_PROBE_GROWTH = 1.25
+"""Growth of throughput estimate per second of writes that aren't limited."""
+_WINDOW = 1.0
+"""Seconds of writes over which the byte rate is compared against the budget."""
+_SATURATION = 0.9
+"""Proportion of the budget used over a window at which output is limited."""
+_RECOVERY_TIME = 5.0
+"""Seconds without a limited window before full color precision is restored."""
+
+
+class BandwidthMonitor:
+    """
+    Measure output throughput and pace writes to stay within a byte rate budget.
+
+    Throughput can only be measured when writes block, i.e., when the output stream
+    (or a slow link behind it) drains slower than frames are written. The estimate
+    grows while writes don't block to probe for more bandwidth.
+
+    Output is limited once the byte rate over a window of writes reaches the budget.
+    Pacing keeps the byte rate from exceeding the budget (newer frames replace frames
+    waiting to be written), so nearly saturating it counts. A single large write,
+    e.g., a full repaint, doesn't limit output on its own.
+
+    Parameters
+    ----------
+    limit : float | None, default: None
+        Budget in bytes per second. If not given, the budget is a proportion of
+        measured throughput.
+
+    Attributes
+    ----------
+    limit : float | None
+        Budget in bytes per second.
+    throughput : float | None
+        Estimated throughput in bytes per second, if any write has blocked.
+    budget : float | None
+        Budget in bytes per second.
+    is_limited : bool
+        Whether the byte rate recently reached the budget.
+
+    Methods
+    -------
+    record(nbytes, start, end)
+        Record a write.
+    delay()
+        Seconds to wait before the next write to stay within budget.
+    """
+
+    def __init__(self, limit: float | None = None):
+        self.limit = limit
+        self.throughput: float | None = None
+        """Estimated throughput in bytes per second, if any write has blocked."""
+        self._last_write = 0.0
+        """End of last write."""
+        self._next_write = 0.0
+        """Earliest time of next write within budget."""
+        self._last_limited = float("-inf")
+        """End of last window in which the byte rate reached the budget."""
+        self._window_start: float | None = None
+        """Start of current window of writes."""
+        self._window_bytes = 0
+        """Bytes written in current window."""
+
+    @property
+    def budget(self) -> float | None:
+        """Budget in bytes per second."""
+        if self.limit is not None:
+            return self.limit
+        if self.throughput is not None:
+            return _HEADROOM * self.throughput
+        return None
+
+    @property
+    def is_limited(self) -> bool:
+        """Whether the byte rate recently reached the budget."""
+        return perf_counter() - self._last_limited < _RECOVERY_TIME
+
+    def record(self, nbytes: int, start: float, end: float):
+        """
+        Record a write.
+
+        Parameters
+        ----------
+        nbytes : int
+            Number of bytes written.
+        start : float
+            :func:`time.perf_counter` at start of write.
+        end : float
+            :func:`time.perf_counter` at end of write.
+        """
+        if nbytes and end - start >= _BLOCKED_WRITE:
+            rate = nbytes / (end - start)
+            if self.throughput is None:
+                self.throughput = rate
+            else:
+                self.throughput += _SMOOTHING * (rate - self.throughput)
+        elif self.throughput is not None:
+            elapsed = min(end - self._last_write, _RECOVERY_TIME)
+            self.throughput *= _PROBE_GROWTH**elapsed
+        self._last_write = end
+
+        budget = self.budget
+        self._next_write = start + nbytes / budget if budget else end
+
+        if self._window_start is None:
+            self._window_start = start
+        self._window_bytes += nbytes
+        elapsed = end - self._window_start
+        if elapsed >= _WINDOW:
+            if budget and self._window_bytes / elapsed >= _SATURATION * budget:
+                self._last_limited = end
+            self._window_start = end
+            self._window_bytes = 0
+
+    def delay(self) -> float:
+        """Seconds to wait before the next write to stay within budget."""
+        return max(self._next_write - perf_counter(), 0.0)
@@ -0,0 +1,184 @@
+"""Run-length ANSI encoding of frame diffs."""
+from typing import Literal
+
+import numpy as np
+from numpy.typing import NDArray
+
+from ...gadgets.text_tools import Cell, cell_bytes, char_widths
+from ...geometry import Rect
+
+__all__ = ["ColorMode", "encode_frame"]
+
+ColorMode = Literal["truecolor", "256"]
+"""Colors used to encode frames: 24-bit colors or the xterm 256-color palette."""
+
+_STYLES = ("bold", "italic", "underline", "strikethrough", "overline")
+"""Style fields of a Cell."""
+_SGR_STYLES = ("1;", "3;", "4;", "9;", "53;")
+"""SGR parameters for each style in `_STYLES`."""
+_CUBE_LEVELS = np.array([0, 95, 135, 175, 215, 255])
+"""Channel values of the 6x6x6 color cube of the xterm 256-color palette."""
+
+
+def _first_or_changed(array: NDArray) -> NDArray[np.bool_]:
+    """Whether each row of a 2-dimensional array is first or differs from the last."""
+    changed = np.ones(len(array), dtype=bool)
+    np.any(array[1:] != array[:-1], axis=1, out=changed[1:])
+    return changed
+
+
+def _sgr_colors(colors: NDArray[np.integer], param: str) -> list[str]:
+    """
+    Return SGR parameters that set colors given as rows of RGB values or of 256-color
+    palette indices. `param` is "38" for foreground colors or "48" for background.
+    """
+    if colors.shape[1] == 1:
+        return [f"{param};5;{n}" for n, in colors.tolist()]
+    return [f"{param};2;{r};{g};{b}" for r, g, b in colors.tolist()]
+
+
+def _to_256(colors: NDArray[np.uint8]) -> NDArray[np.int_]:
+    """
+    Return the nearest color in the color cube or grayscale ramp of the xterm
+    256-color palette to each color as a (N, 1)-shaped array of palette indices.
+    """
+    colors = colors.astype(int)
+    cube = np.where(colors < 48, 0, np.where(colors < 115, 1, (colors - 35) // 40))
+    cube_index = 16 + cube @ [36, 6, 1]
+    cube_error = ((_CUBE_LEVELS[cube] - colors) ** 2).sum(axis=-1)
+
+    gray = ((colors.sum(axis=-1) // 3 - 3) // 10).clip(0, 23)
+    gray_error = ((8 + 10 * gray[:, None] - colors) ** 2).sum(axis=-1)
+    return np.where(gray_error < cube_error, 232 + gray, cube_index)[:, None]
+
+
+def encode_frame(
+    canvas: NDArray[Cell],
+    last_canvas: NDArray[Cell],
+    full: bool = False,
+    damage: Rect | None = None,
+    colors: ColorMode = "truecolor",
+) -> str:
+    """
+    Encode the difference of two canvases as ANSI escape sequences.
+
+    Changed cells are coalesced into horizontal runs. The cursor is only moved at the
+    start of a run that isn't adjacent to the previous run and only SGR parameters that
+    differ from the previous run are emitted.
+
+    This is an internal function used by :meth:`Vt100_Output.render_frame`.
+
+    Parameters
+    ----------
+    canvas : NDArray[Cell]
+        The canvas to encode.
+    last_canvas : NDArray[Cell]
+        The last encoded canvas.
+    full : bool, default: False
+        Whether to encode every cell of `canvas` instead of only changed cells.
+    damage : Rect | None, default: None
+        If given, only cells within this rect are compared.
+    colors : ColorMode, default: "truecolor"
+        Colors used to encode cells. With "256", colors are quantized to the xterm
+        256-color palette, which takes fewer bytes and coalesces into longer runs.
+
+    Returns
+    -------
+    str
+        ANSI escape sequences that paint the changed cells of `canvas`.
+    """
+    h, w = canvas.shape
+    chars = canvas["char"]
+
+    # Cells are compared byte-wise; comparing structured arrays compares each field
+    # separately.
+    if full:
+        changed = np.ones((h, w), dtype=bool)
+    elif damage is None:
+        changed = np.any(cell_bytes(canvas) != cell_bytes(last_canvas), axis=-1)
+    else:
+        changed = np.zeros((h, w), dtype=bool)
+        rect = damage.to_slices()
+        raw = cell_bytes(canvas[rect]) != cell_bytes(last_canvas[rect])
+        np.any(raw, axis=-1, out=changed[rect])
+
+    # `""` is used to indicate the character before it is a full-width character. If
+    # this char is appearing in the diffs, we need to repaint the full-width character
+    # before it, but if the character before it isn't full-width paint whitespace
+    # instead (below).
+    ys, xs = (changed[:, 1:] & (chars[:, 1:] == "")).nonzero()
+    xs += 1
+    trailing = char_widths(chars[ys, xs - 1]) == 2
+    ys, xs = ys[trailing], xs[trailing]
+    changed[ys, xs] = False
+    changed[ys, xs - 1] = True
+
+    ys, xs = changed.nonzero()
+    if len(ys) == 0:
+        return ""
+
+    cells = canvas[ys, xs]
+    out_chars = cells["char"]
+    widths = char_widths(out_chars)
+
+    # If a character is full-width, but the following character isn't `""`, assume the
+    # full-width character is being clipped, and paint whitespace instead.
+    next_xs = np.minimum(xs + 1, w - 1)
+    clipped = (widths == 2) & (xs + 1 < w) & (chars[ys, next_xs] != "")
+    blank = clipped | (out_chars == "")
+    out_chars[blank] = " "
+    widths[blank] = 1
+
+    # The terminal cursor advances by the width of each character painted, so the cursor
+    # only needs to move if a cell isn't where the last cell left the cursor.
+    cursor_xs = xs + widths
+    moved = np.ones(len(ys), dtype=bool)
+    moved[1:] = (ys[1:] != ys[:-1]) | (xs[1:] != cursor_xs[:-1])
+
+    styles = np.stack([cells[style] for style in _STYLES], axis=-1)
+    if colors == "256":
+        fgs = _to_256(cells["fg_color"])
+        bgs = _to_256(cells["bg_color"])
+    else:
+        fgs = cells["fg_color"]
+        bgs = cells["bg_color"]
+    style_changed = _first_or_changed(styles)
+    fg_changed = _first_or_changed(fgs)
+    bg_changed = _first_or_changed(bgs)
+
+    # A run continues until the cursor moves or any attribute changes.
+    starts = (moved | style_changed | fg_changed | bg_changed).nonzero()[0]
+    runs = zip(
+        starts.tolist(),
+        [*starts[1:].tolist(), len(ys)],
+        ys[starts].tolist(),
+        xs[starts].tolist(),
+        moved[starts].tolist(),
+        style_changed[starts].tolist(),
+        fg_changed[starts].tolist(),
+        bg_changed[starts].tolist(),
+        styles[starts].tolist(),
+        _sgr_colors(fgs[starts], "38"),
+        _sgr_colors(bgs[starts], "48"),
+    )
+
+    chars_list = out_chars.tolist()
+    out = []
+    write = out.append
+    for start, end, y, x, move, new_style, new_fg, new_bg, style, fg, bg in runs:
+        if move:
+            write(f"\x1b[{y + 1};{x + 1}H")  # Move cursor to (y, x)
+
+        if new_style:
+            sgr = "".join(param for param, is_set in zip(_SGR_STYLES, style) if is_set)
+            write(f"\x1b[0;{sgr}{fg};{bg}m")  # Reset
+        elif new_fg and new_bg:
+            write(f"\x1b[{fg};{bg}m")
+        elif new_fg:
+            write(f"\x1b[{fg}m")
+        elif new_bg:
+            write(f"\x1b[{bg}m")
+
+        write("".join(chars_list[start:end]))
+
+    return "".join(out)
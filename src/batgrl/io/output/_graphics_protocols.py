@@ -0,0 +1,290 @@
+"""Output of graphic gadgets with the kitty and sixel terminal graphics protocols."""
+import re
+import tempfile
+import zlib
+from base64 import standard_b64encode
+from typing import Literal, NamedTuple
+
+import cv2
+import numpy as np
+from numpy.typing import NDArray
+
+from ...geometry import Point, Region, Size
+
+__all__ = [
+    "GraphicsProtocol",
+    "ImagePlacement",
+    "KittyEncoder",
+    "SixelEncoder",
+    "rects_region",
+]
+
+GraphicsProtocol = Literal["half-blocks", "kitty", "sixel"]
+"""
+How graphic gadgets are output. "half-blocks" paints textures into the canvas with
+the upper half block character, "▀". "kitty" and "sixel" send textures to the
+terminal as images.
+"""
+
+Rects = tuple[tuple[int, int, int, int], ...]
+"""(top, bottom, left, right) rects on screen."""
+
+_KITTY_CHUNK_SIZE = 4096
+"""Max size of a chunk of a kitty graphics protocol payload."""
+_SIXEL_RUN = re.compile(r"(.)\1{3,}")
+"""Runs of sixels long enough to be shorter when run-length encoded."""
+
+
+class ImagePlacement(NamedTuple):
+    """The visible portion of a graphic gadget's texture in a frame."""
+
+    id: int
+    """Unique id of the image."""
+    texture: NDArray[np.uint8]
+    """RGBA texture with gadget alpha applied. Two texture rows per cell row."""
+    pos: Point
+    """Absolute position of gadget."""
+    rects: Rects
+    """Visible rects of gadget on screen."""
+
+    def is_unchanged(self, other: "ImagePlacement") -> bool:
+        """Whether another placement places the same texture in the same rects."""
+        return (
+            self.pos == other.pos
+            and self.rects == other.rects
+            and np.array_equal(self.texture, other.texture)
+        )
+
+
+def rects_region(rects: Rects) -> Region:
+    """Return the region covered by rects."""
+    region = Region()
+    for top, bottom, left, right in rects:
+        region |= Region.from_rect(Point(top, left), Size(bottom - top, right - left))
+    return region
+
+
+def _source_rect(placement: ImagePlacement, rect: tuple[int, int, int, int]):
+    """Return (y, x, h, w) of the texture pixels shown in a rect on screen."""
+    top, bottom, left, right = rect
+    y, x = placement.pos
+    return 2 * (top - y), left - x, 2 * (bottom - top), right - left
+
+
+class KittyEncoder:
+    """
+    Encode images with the kitty graphics protocol.
+
+    Images are kept by the terminal, so a texture is only transmitted when it changes
+    and is only re-placed when its visible rects change. Each visible rect of a gadget
+    is a separate placement that crops the texture to the rect, so gadgets in front of
+    an image aren't covered by it.
+
+    Parameters
+    ----------
+    transfer_files : bool
+        Whether textures are transmitted through temporary files instead of through
+        the output stream. The terminal must be on the same machine.
+    """
+
+    def __init__(self, transfer_files: bool):
+        self.transfer_files = transfer_files
+        self._sent: dict[int, ImagePlacement] = {}
+        """Last placement of each image in the terminal."""
+
+    def reset(self) -> str:
+        """Forget all images and return escapes that delete them in the terminal."""
+        self._sent.clear()
+        return "\x1b_Ga=d,d=A,q=2\x1b\\"
+
+    def encode(self, placements: list[ImagePlacement]) -> str:
+        """Return escapes that update images in the terminal to match placements."""
+        out = []
+        current = {placement.id: placement for placement in placements}
+        for id_ in self._sent.keys() - current.keys():
+            out.append(f"\x1b_Ga=d,d=I,i={id_},q=2\x1b\\")
+            del self._sent[id_]
+
+        for placement in placements:
+            id_ = placement.id
+            sent = self._sent.get(id_)
+            if sent is None:
+                out.append(self._transmit(placement))
+            elif placement.is_unchanged(sent):
+                continue
+            elif np.array_equal(sent.texture, placement.texture):
+                out.append(f"\x1b_Ga=d,d=i,i={id_},q=2\x1b\\")  # Delete placements.
+            else:
+                # Delete image, including its placements, and transmit new texture.
+                out.append(f"\x1b_Ga=d,d=I,i={id_},q=2\x1b\\")
+                out.append(self._transmit(placement))
+
+            for n, rect in enumerate(placement.rects, start=1):
+                top, bottom, left, right = rect
+                y, x, h, w = _source_rect(placement, rect)
+                out.append(
+                    f"\x1b[{top + 1};{left + 1}H"  # Move cursor to (top, left)
+                    f"\x1b_Ga=p,i={id_},p={n},x={x},y={y},w={w},h={h},"
+                    f"c={right - left},r={bottom - top},C=1,q=2\x1b\\"
+                )
+            self._sent[id_] = placement
+
+        return "".join(out)
+
+    def _transmit(self, placement: ImagePlacement) -> str:
+        """Return escapes that transmit a texture."""
+        texture = placement.texture
+        h, w, _ = texture.shape
+        header = f"a=t,f=32,s={w},v={h},i={placement.id},q=2"
+
+        if self.transfer_files:
+            # The terminal deletes the file after reading it.
+            with tempfile.NamedTemporaryFile(
+                prefix="tty-graphics-protocol-", delete=False
+            ) as file:
+                file.write(texture.tobytes())
+            path = standard_b64encode(file.name.encode()).decode()
+            return f"\x1b_G{header},t=t;{path}\x1b\\"
+
+        data = standard_b64encode(zlib.compress(texture.tobytes(), 1)).decode()
+        chunks = [
+            data[i : i + _KITTY_CHUNK_SIZE]
+            for i in range(0, len(data), _KITTY_CHUNK_SIZE)
+        ]
+        out = []
+        for i, chunk in enumerate(chunks):
+            more = int(i < len(chunks) - 1)
+            if i == 0:
+                out.append(f"\x1b_G{header},o=z,m={more};{chunk}\x1b\\")
+            else:
+                out.append(f"\x1b_Gm={more};{chunk}\x1b\\")
+        return "".join(out)
+
+
+def encode_sixel(pixels: NDArray[np.uint8]) -> str:
+    """
+    Encode RGBA pixels as a sixel image.
+
+    Colors are quantized to a 6x6x6 color cube. Pixels with alpha below 128 aren't
+    drawn.
+
+    Parameters
+    ----------
+    pixels : NDArray[np.uint8]
+        RGBA pixels.
+
+    Returns
+    -------
+    str
+        A sixel escape sequence.
+    """
+    h, w, _ = pixels.shape
+    nbands = -(-h // 6)
+    indices = np.full((6 * nbands, w), -1, np.int16)
+    cube = (pixels[..., :3].astype(np.uint16) * 5 + 127) // 255
+    indices[:h] = cube @ np.array([36, 6, 1], np.uint16)
+    indices[:h][pixels[..., 3] < 128] = -1
+
+    out = [f'\x1bP0;1;0q"1;1;{w};{h}']
+    for color in np.unique(indices[indices >= 0]).tolist():
+        r, g, b = color // 36 * 20, color // 6 % 6 * 20, color % 6 * 20
+        out.append(f"#{color};2;{r};{g};{b}")
+
+    bits = (1 << np.arange(6, dtype=np.uint8))[:, None]
+    for band in indices.reshape(nbands, 6, w):
+        colors = np.unique(band[band >= 0]).tolist()
+        for i, color in enumerate(colors):
+            sixels = ((band == color) * bits).sum(axis=0, dtype=np.uint8) + 63
+            row = sixels.tobytes().decode().rstrip("?")
+            row = _SIXEL_RUN.sub(lambda m: f"!{len(m[0])}{m[1]}", row)
+            out.append(f"#{color}{row}")
+            if i < len(colors) - 1:
+                out.append("$")  # Return to start of band.
+        out.append("-")  # Next band.
+
+    out.append("\x1b\\")
+    return "".join(out)
+
+
+class SixelEncoder:
+    """
+    Encode images as sixels.
+
+    Sixels are drawn into the terminal's cells, so an image is redrawn whenever text
+    is painted over it, and the cells it covered are repainted when it changes or
+    moves. Images are scaled to the pixel size of cells.
+    """
+
+    def __init__(self):
+        self._sent: dict[int, ImagePlacement] = {}
+        """Last placement of each image drawn in the terminal."""
+
+    def reset(self):
+        """Forget all drawn images."""
+        self._sent.clear()
+
+    def plan(
+        self, placements: list[ImagePlacement], overwritten: set[int]
+    ) -> tuple[list[ImagePlacement], Region]:
+        """
+        Return the images to draw and the region of the screen that must be repainted
+        with text before they are drawn.
+
+        Parameters
+        ----------
+        placements : list[ImagePlacement]
+            The placements of images in the frame.
+        overwritten : set[int]
+            Ids of images that will be painted over by text.
+
+        Returns
+        -------
+        tuple[list[ImagePlacement], Region]
+            The images to draw and the region to repaint.
+        """
+        current = {placement.id: placement for placement in placements}
+        redraw = set(overwritten)
+        repaint = Region()
+        for id_, sent in self._sent.items():
+            placement = current.get(id_)
+            if placement is None or not placement.is_unchanged(sent):
+                repaint |= rects_region(sent.rects)
+                redraw.add(id_)
+        for id_ in current.keys() - self._sent.keys():
+            redraw.add(id_)
+
+        # Repainting with text draws over any other image in the repainted region.
+        for placement in placements:
+            if rects_region(placement.rects) & repaint:
+                redraw.add(placement.id)
+
+        self._sent = current
+        drawn = [placement for placement in placements if placement.id in redraw]
+        return drawn, repaint
+
+    def encode(
+        self, placements: list[ImagePlacement], cell_size: Size, screen_height: int
+    ) -> str:
+        """
+        Return sixels of the visible rects of placements.
+
+        Rects are clipped above the last row of the screen, as drawing a sixel there
+        scrolls the screen in most terminals.
+        """
+        cell_h, cell_w = cell_size
+        out = []
+        for placement in placements:
+            for rect in placement.rects:
+                top, bottom, left, right = rect
+                bottom = min(bottom, screen_height - 1)
+                if bottom <= top:
+                    continue
+                y, x, _, w = _source_rect(placement, rect)
+                source = placement.texture[y : y + 2 * (bottom - top), x : x + w]
+                pixels = cv2.resize(
+                    source,
+                    ((right - left) * cell_w, (bottom - top) * cell_h),
+                    interpolation=cv2.INTER_NEAREST,
+                )
+                out.append(f"\x1b[{top + 1};{left + 1}H{encode_sixel(pixels)}")
+        return "".join(out)
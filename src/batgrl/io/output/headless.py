@@ -0,0 +1,68 @@
+"""Output for apps run without a terminal."""
+import os
+from io import BytesIO
+from pathlib import Path
+from typing import BinaryIO
+
+from ...geometry import Size
+from .vt100 import _DEFAULT_CELL_SIZE, Vt100_Output
+
+__all__ = ["HeadlessOutput"]
+
+
+class HeadlessOutput(Vt100_Output):
+    """
+    Output for apps run without a terminal.
+
+    Frames are rendered at a fixed size and written as vt100 escapes to a binary
+    stream or file descriptor, e.g., a socket to stream to a web terminal.
+
+    Parameters
+    ----------
+    size : Size
+        Size of output.
+    stream : BinaryIO | int | None, default: None
+        Binary stream or file descriptor output is written to. If not provided, output
+        is written to a new :class:`io.BytesIO`.
+    asciicast_path : Path | None, default: None
+        Record output in asciicast v2 file format if a path is provided.
+
+    Attributes
+    ----------
+    size : Size
+        Size of output.
+    stream : BinaryIO | int
+        Binary stream or file descriptor output is written to.
+    """
+
+    def __init__(
+        self,
+        size: Size,
+        stream: BinaryIO | int | None = None,
+        asciicast_path: Path | None = None,
+    ):
+        self.size = Size(*size)
+        self.stream = BytesIO() if stream is None else stream
+        super().__init__(asciicast_path)
+
+    def get_size(self) -> Size:
+        """Get output size."""
+        return self.size
+
+    def get_cell_size(self) -> Size:
+        """Get pixel size of a cell."""
+        return _DEFAULT_CELL_SIZE
+
+    def _is_local(self) -> bool:
+        """Output isn't assumed to be read on this machine."""
+        return False
+
+    def _write_bytes(self, data: bytes):
+        """Write data to output stream."""
+        if isinstance(self.stream, int):
+            view = memoryview(data)
+            while view:
+                view = view[os.write(self.stream, view) :]
+        else:
+            self.stream.write(data)
+            self.stream.flush()
@@ -1,19 +1,35 @@
 """Output for vt100 terminals."""
-import json
 import os
 import shutil
-import sys
 import time
+from concurrent.futures import Future, ThreadPoolExecutor
 from pathlib import Path
 from sys import stdout
+from threading import Lock
 
 import numpy as np
+from numpy.typing import NDArray
 
 from ...gadgets._root import _Root
-from ...gadgets.text_tools import char_width
-from ...geometry import Size
-
-MAX_MEM_USAGE = 5_000_000
+from ...gadgets.text_tools import Cell, cell_bytes
+from ...geometry import Region, Size
+from ._asciicast import AsciicastRecorder
+from ._bandwidth import BandwidthMonitor
+from ._frame_encoder import ColorMode, encode_frame
+from ._graphics_protocols import (
+    GraphicsProtocol,
+    ImagePlacement,
+    KittyEncoder,
+    SixelEncoder,
+)
+
+_DEFAULT_CELL_SIZE = Size(20, 10)
+"""Pixel size of a cell if the terminal doesn't report it."""
+_REMOTE_VARIABLES = ("SSH_CLIENT", "SSH_CONNECTION", "SSH_TTY")
+"""Environment variables set in remote sessions."""
+
+_Frame = tuple[NDArray[Cell], bool, Region, GraphicsProtocol, list[ImagePlacement]]
+"""A (canvas, resized, damage, graphics protocol, image placements) tuple."""
 
 
 class Vt100_Output:
@@ -22,53 +38,83 @@ class Vt100_Output:
     def __init__(self, asciicast_path: Path | None = None):
         self.term = os.environ.get("TERM", "")
         self._buffer = []
+        self.frame_bytes = 0
+        """Number of bytes written for the last rendered frame."""
+        self.skipped_frames = 0
+        """Number of frames replaced by newer frames before they could be written."""
+        self.encode_time = 0.0
+        """Seconds spent encoding the last written frame."""
+        self.write_time = 0.0
+        """Seconds spent writing the last written frame."""
+        self.synchronized_output = True
+        """
+        Whether frames are wrapped in synchronized output (DEC mode 2026) so that
+        terminals don't display them half-written. Terminals that don't support it
+        ignore it.
+        """
+        self.adaptive_bandwidth = False
+        """
+        Whether frames are paced to stay within :attr:`bandwidth`'s budget and colors
+        are reduced while the byte rate is at the budget.
+        """
+        self.bandwidth = BandwidthMonitor()
+        """Measures throughput of frame writes."""
+        self.color_mode: ColorMode = "truecolor"
+        """Colors used to encode the last written frame."""
+
+        self._write_lock = Lock()
+        """Serializes writes to the output stream."""
+        self._frame_lock = Lock()
+        """Guards the pending frame and writing state."""
+        self._pending: _Frame | None = None
+        """Latest frame not yet encoded."""
+        self._writing = False
+        """Whether the frame writer is running."""
+        self._sent: NDArray[Cell] | None = None
+        """The last canvas written to the output stream."""
+        self._executor: ThreadPoolExecutor | None = None
+        self._future: Future | None = None
 
         self.asciicast_path = asciicast_path
+        self._kitty = KittyEncoder(
+            transfer_files=self._is_local() and asciicast_path is None
+        )
+        """Encoder of graphic gadgets with the kitty graphics protocol."""
+        self._sixel = SixelEncoder()
+        """Encoder of graphic gadgets as sixels."""
 
         if asciicast_path is not None:
             self._init_asciicast()
 
     def _init_asciicast(self):
-        size = self.get_size()
-
-        metadata = {
-            "version": 2,
-            "width": size.width,
-            "height": size.height,
-            "timestamp": int(time.time()),
-            "env": {
-                "TERM": self.term,
-                "SHELL": os.environ.get("SHELL", ""),
-            },
-        }
-
-        self.asciicast_path.write_text(json.dumps(metadata) + "\n")
-
-        self._asciicast_buffer = []
-        self._initial_time = time.monotonic()
-        self._mem_usage = 0
-
-    def _create_asciicast_frame(self, data):
-        frame = [time.monotonic() - self._initial_time, "o", data.decode("utf-8")]
-        self._asciicast_buffer.append(json.dumps(frame) + "\n")
-        self._mem_usage += sys.getsizeof(self._asciicast_buffer[-1])
-
-        if self._mem_usage > MAX_MEM_USAGE:
-            self._write_asciicast_buffer()
-
-    def _write_asciicast_buffer(self):
-        """Append frames in asciicast buffer to file."""
-        with self.asciicast_path.open("a") as f:
-            f.writelines(self._asciicast_buffer)
-
-        self._asciicast_buffer.clear()
-        self._mem_usage = 0
+        env = {"TERM": self.term, "SHELL": os.environ.get("SHELL", "")}
+        self._recorder = AsciicastRecorder(self.asciicast_path, self.get_size(), env)
 
     def get_size(self) -> Size:
         """Get terminal size."""
         cols, rows = shutil.get_terminal_size()
         return Size(rows, cols)
 
+    def get_cell_size(self) -> Size:
+        """Get pixel size of a terminal cell or a common size if it isn't reported."""
+        try:
+            import fcntl
+            import struct
+            import termios
+
+            winsize = fcntl.ioctl(stdout.fileno(), termios.TIOCGWINSZ, bytes(8))
+        except (ImportError, OSError, ValueError):
+            return _DEFAULT_CELL_SIZE
+
+        rows, cols, xpixels, ypixels = struct.unpack("HHHH", winsize)
+        if not (rows and cols and xpixels and ypixels):
+            return _DEFAULT_CELL_SIZE
+        return Size(ypixels // rows, xpixels // cols)
+
+    def _is_local(self) -> bool:
+        """Whether the terminal is on this machine."""
+        return not any(variable in os.environ for variable in _REMOTE_VARIABLES)
+
     def set_title(self, title):
         """Set terminal title."""
         if self.term not in ("linux", "eterm-color"):
@@ -111,26 +157,44 @@ class Vt100_Output:
         """Show cursor in terminal."""
         self._buffer.append("\x1b[?25h")
 
-    def flush(self):
-        """Write to output stream and flush. If recording, output is saved."""
+    def flush(self) -> int:
+        """
+        Write to output stream and flush. If recording, output is saved.
+
+        Returns
+        -------
+        int
+            Number of bytes written.
+        """
         if not self._buffer:
-            return
+            return 0
 
-        data = "".join(self._buffer).encode(errors="replace")
+        data = "".join(self._buffer)
         self._buffer.clear()
+        return self._write(data)
 
-        if self.asciicast_path is not None:
-            self._create_asciicast_frame(data)
+    def _write(self, data: str) -> int:
+        """Write data to output stream. Can be called from any thread."""
+        encoded = data.encode(errors="replace")
+        with self._write_lock:
+            if self.asciicast_path is not None:
+                self._recorder.record(data)
 
+            self._write_bytes(encoded)
+        return len(encoded)
+
+    def _write_bytes(self, data: bytes):
+        """Write data to output stream."""
         stdout.buffer.write(data)
         stdout.flush()
 
     def restore_console(self):
         """Restore console and finalize asciicast if recording."""
         if self.asciicast_path:
-            self._write_asciicast_buffer()
+            self._recorder.close()
 
     def __enter__(self):
+        self._executor = ThreadPoolExecutor(1, thread_name_prefix="batgrl-output")
         self.enable_mouse_support()
         self.enable_bracketed_paste()
         self.enter_alternate_screen()
@@ -138,6 +202,14 @@ class Vt100_Output:
         self.flush()
 
     def __exit__(self, exc_type, exc_value, traceback):
+        # Let the last frame finish writing before leaving the alternate screen.
+        self._executor.shutdown(wait=True)
+        self._executor = None
+        self._pending = None
+        self._sent = None
+        if self._kitty._sent:
+            self._buffer.append(self._kitty.reset())
+        self._sixel.reset()
         self.quit_alternate_screen()
         self.reset_attributes()
         self.disable_mouse_support()
@@ -147,72 +219,165 @@ class Vt100_Output:
         self.restore_console()
 
     def render_frame(self, root: _Root):
-        """Render a frame of the running app."""
-        canvas = root.canvas
-        h, w = root.size
-        if root._resized:
-            root._resized = False
-            ys, xs = np.indices((h, w)).reshape(2, h * w)
+        """
+        Render a frame of the running app.
+
+        Frames are encoded and written on a worker thread so that slow terminals don't
+        block the event loop. If the previous frame hasn't finished writing, this frame
+        becomes the pending frame, replacing any frame not yet written. Only the latest
+        frame is sent and it is diffed against the last frame actually written. Outside
+        of the output's context, frames are written synchronously and never paced.
+        """
+        if self._future is not None and self._future.done():
+            self._future.result()  # Re-raise any exception from the writer.
+            self._future = None
+
+        resized = root._resized
+        root._resized = False
+        if not resized and not root._last_damage:
+            return
+
+        canvas = root.canvas.copy()
+        protocol = root.graphics_protocol
+        images = root._image_placements()
+        with self._frame_lock:
+            if self._pending is not None:
+                _, last_resized, last_damage, _, _ = self._pending
+                resized |= last_resized
+                damage = last_damage | root._last_damage
+                self.skipped_frames += 1
+            else:
+                damage = root._last_damage
+
+            self._pending = canvas, resized, damage, protocol, images
+            if self._writing:
+                return
+            self._writing = True
+
+        if self._executor is None:
+            self._write_frames(pace=False)
+        else:
+            self._future = self._executor.submit(self._write_frames)
+
+    def _write_frames(self, pace: bool = True):
+        """
+        Encode and write pending frames until none remain. If `pace`, frames are
+        delayed to stay within :attr:`bandwidth`'s budget.
+        """
+        try:
+            while True:
+                if (
+                    pace
+                    and self.adaptive_bandwidth
+                    and (delay := self.bandwidth.delay())
+                ):
+                    # Newer frames replace pending frames while waiting.
+                    time.sleep(delay)
+
+                with self._frame_lock:
+                    if self._pending is None:
+                        self._writing = False
+                        return
+                    frame, self._pending = self._pending, None
+
+                self._write_frame(*frame)
+        except BaseException:
+            # Hand off any pending frame to the next writer. What reached the terminal
+            # is unknown, so the next frame is written in full.
+            with self._frame_lock:
+                self._sent = None
+                self._writing = False
+            raise
+
+    def _write_frame(
+        self,
+        canvas: NDArray[Cell],
+        full: bool,
+        damage: Region,
+        protocol: GraphicsProtocol,
+        images: list[ImagePlacement],
+    ):
+        """Encode and write a frame."""
+        if self.adaptive_bandwidth and self.bandwidth.is_limited:
+            color_mode = "256"
         else:
-            diffs = root._last_canvas != canvas
-            ys, xs = diffs.nonzero()
-
-        write = self._buffer.append
-
-        write("\x1b7")  # Save cursor
-        for y, x, cell in zip(ys, xs, canvas[ys, xs]):
-            (
-                char,
-                bold,
-                italic,
-                underline,
-                strikethrough,
-                overline,
-                (fr, fg, fb),  # foreground color
-                (br, bg, bb),  # background color
-            ) = cell.item()
-
-            # The following conditions ensure full-width glyphs "have enough room" else
-            # they are not painted.
-            if char == "":
-                # `""` is used to indicate the character before it is a full-width
-                # character. If this char is appearing in the diffs, we probably need to
-                # repaint the full-width character before it, but if the character
-                # before it isn't full-width paint whitespace instead.
-                if x > 0 and char_width(canvas["char"][y, x - 1].item()) == 2:
-                    x -= 1
-                    (
-                        char,
-                        bold,
-                        italic,
-                        underline,
-                        strikethrough,
-                        overline,
-                        (fr, fg, fb),
-                        (br, bg, bb),
-                    ) = canvas[y, x].item()
-                else:
-                    char = " "
-            elif (
-                x + 1 < w
-                and canvas["char"][y, x + 1].item() != ""
-                and char_width(char) == 2
-            ):
-                # If the character is full-width, but the following character isn't
-                # `""`, assume the full-width character is being clipped, and paint
-                # whitespace instead.
-                char = " "
-
-            write(
-                f"\x1b[{y + 1};{x + 1}H"  # Move cursor to (y, x)
-                "\x1b[0;"  # Reset
-                f"{'1;' if bold else ''}"
-                f"{'3;' if italic else ''}"
-                f"{'4;' if underline else ''}"
-                f"{'9;' if strikethrough else ''}"
-                f"{'53;' if overline else ''}"
-                f"38;2;{fr};{fg};{fb};48;2;{br};{bg};{bb}m"  # Set color pair
-                f"{char}"
+            color_mode = "truecolor"
+        if color_mode != self.color_mode:
+            # Repaint cells encoded with reduced colors once bandwidth recovers.
+            full |= color_mode == "truecolor"
+            self.color_mode = color_mode
+
+        sent = self._sent
+        if sent is None or sent.shape != canvas.shape:
+            full = True
+            sent = canvas
+
+        start = time.perf_counter()
+        kitty_images = images if protocol == "kitty" else []
+        sixel_images = images if protocol == "sixel" else []
+        prefix = self._kitty.reset() if full and self._kitty._sent else ""
+        if full:
+            self._sixel.reset()
+
+        sixels, repaint = self._sixel.plan(
+            sixel_images, self._overwritten(sixel_images, canvas, sent, full)
+        )
+        if repaint and not full:
+            # Repaint cells that were covered by sixels that changed or moved.
+            damage = damage | repaint
+            sent = sent.copy()
+            for rect in repaint.rects():
+                dst = rect.to_slices()
+                sent["fg_color"][dst] = ~canvas["fg_color"][dst]
+
+        frame = encode_frame(canvas, sent, full, damage.bbox, color_mode)
+        if kitty_images or self._kitty._sent:
+            frame += self._kitty.encode(kitty_images)
+        if sixels:
+            cell_size = self.get_cell_size()
+            frame += self._sixel.encode(sixels, cell_size, canvas.shape[0])
+        frame = prefix + frame
+        self._sent = canvas
+        encoded = time.perf_counter()
+
+        if not frame:
+            self.frame_bytes = 0
+        elif self.synchronized_output:
+            self.frame_bytes = self._write(
+                "\x1b[?2026h"  # Begin synchronized update
+                "\x1b7"  # Save cursor
+                f"{frame}"
+                "\x1b8"  # Restore cursor
+                "\x1b[?2026l"  # End synchronized update
             )
-        write("\x1b8")  # Restore cursor
-        self.flush()
+        else:
+            self.frame_bytes = self._write(
+                "\x1b7"  # Save cursor
+                f"{frame}"
+                "\x1b8"  # Restore cursor
+            )
+        written = time.perf_counter()
+        self.bandwidth.record(self.frame_bytes, encoded, written)
+
+        self.encode_time = encoded - start
+        self.write_time = written - encoded
+
+    def _overwritten(
+        self,
+        images: list[ImagePlacement],
+        canvas: NDArray[Cell],
+        sent: NDArray[Cell],
+        full: bool,
+    ) -> set[int]:
+        """Return ids of images whose cells will be painted over by a frame."""
+        if full:
+            return {image.id for image in images}
+
+        overwritten = set()
+        for image in images:
+            for top, bottom, left, right in image.rects:
+                dst = slice(top, bottom), slice(left, right)
+                if np.any(cell_bytes(canvas[dst]) != cell_bytes(sent[dst])):
+                    overwritten.add(image.id)
+                    break
+        return overwritten